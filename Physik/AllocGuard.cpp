@@ -0,0 +1,72 @@
+#include "AllocGuard.h"
+
+#ifdef PHYSIK_ALLOC_GUARD
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static thread_local AllocGuard* t_pGuard = nullptr;
+
+// The array and sized forms of new and delete forward to these
+void* operator new(size_t size)
+{
+	AllocGuard::CountAllocation();
+
+	void* p = std::malloc(size > 0 ? size : 1);
+	if (p == nullptr)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void AllocGuard::Arm()
+{
+	m_allocCount.store(0);
+	t_pGuard = this;
+}
+
+int AllocGuard::Disarm()
+{
+	if (t_pGuard == this)
+		t_pGuard = nullptr;
+	return m_allocCount.load();
+}
+
+void AllocGuard::Check(const char* szWhere)
+{
+	int count = Disarm();
+	if (count == 0)
+		return;
+
+	fprintf(stderr, "AllocGuard: %s made %d allocation(s) after warm up\n", szWhere, count);
+	std::abort();
+}
+
+AllocGuard* AllocGuard::GetCurrent()
+{
+	return t_pGuard;
+}
+
+void AllocGuard::CountAllocation()
+{
+	if (t_pGuard != nullptr)
+		t_pGuard->m_allocCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocGuard::Scope::Scope(AllocGuard* pGuard) : m_pPrevious(t_pGuard)
+{
+	t_pGuard = pGuard;
+}
+
+AllocGuard::Scope::~Scope()
+{
+	t_pGuard = m_pPrevious;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+
+/***
+ * @brief Test mode for the zero allocation guarantee of PhysicsScene::Update.
+ *			Building with PHYSIK_ALLOC_GUARD defined (the AllocGuard
+ *			configuration) replaces the global operator new with one that
+ *			counts allocations while a guard is armed. Once a scene has warmed
+ *			up, Update arms its guard around the fixed steps and aborts if any
+ *			of them allocated.
+ *
+ * A guard only counts allocations on the thread that armed it and in job
+ *	chunks of its scene's step graph, so other threads, and other scenes
+ *	updating at the same time, don't trip it.
+ */
+class AllocGuard
+{
+public:
+	// Updates allowed to allocate while the scene's storage grows to fit it
+	static const int WARMUP_UPDATES = 120;
+
+	// Starts counting on the calling thread
+	void Arm();
+	// Disarms the guard and returns the allocations made while it was armed
+	int Disarm();
+	// Disarms the guard, aborting if anything allocated while it was armed
+	void Check(const char* szWhere);
+
+	// The guard counting the calling thread's allocations, null if none
+	static AllocGuard* GetCurrent();
+	// Called by the replaced operator new
+	static void CountAllocation();
+
+	/***
+	 * @brief Counts the thread's allocations against another guard, or none,
+	 *			until it goes out of scope. Job chunks enter the guard of the
+	 *			graph run they belong to.
+	 */
+	class Scope
+	{
+	public:
+		Scope(AllocGuard* pGuard);
+		~Scope();
+
+	private:
+		AllocGuard* m_pPrevious;
+	};
+
+private:
+	std::atomic<int> m_allocCount = { 0 };
+};
+
+#ifdef PHYSIK_ALLOC_GUARD
+/***
+ * @brief Headless run of the guard over a scene updated synchronously, one
+ *			stepped asynchronously while the main thread allocates, and two
+ *			scenes updating at once. main runs this instead of the app.
+ * @return 0, a failing check aborts
+ */
+int RunAllocGuardTest();
+#endif
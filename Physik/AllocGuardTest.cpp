@@ -0,0 +1,97 @@
+#include "AllocGuard.h"
+
+#ifdef PHYSIK_ALLOC_GUARD
+
+#include "PhysicsScene.h"
+#include "Plane.h"
+#include "Sphere.h"
+#include "Box.h"
+#include "Poly.h"
+#include "Stitched.h"
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#define FRICTION_COEFFICIENTS 1.0f, 0.5f
+
+// Frames run past the scene's warm up in each check
+static const int GUARDED_FRAMES = 600;
+static const float FRAME_TIME = 1 / 60.0f;
+
+// The app's scene, without anything to draw it with
+static PhysicsScene* MakeScene(aie::JobSystem& jobs)
+{
+	PhysicsScene* pScene = new PhysicsScene();
+	pScene->SetJobSystem(&jobs);
+	pScene->setGravity(vec2(0, -10));
+	pScene->setTimeStep(0.01f);
+
+	pScene->AddActor(new Plane(vec2(-1, 0), 90.0f, FRICTION_COEFFICIENTS));
+	pScene->AddActor(new Plane(vec2(1, 0), 90.0f, FRICTION_COEFFICIENTS));
+	pScene->AddActor(new Plane(vec2(0, 1), 56.0f, FRICTION_COEFFICIENTS));
+	pScene->AddActor(new Plane(vec2(0, -1), 56.0f, FRICTION_COEFFICIENTS));
+	pScene->AddActor(new Plane({ -2.0f,-1 }, 80.0f, FRICTION_COEFFICIENTS));
+
+	pScene->AddActor(new Box({ 5,5 }, { 0, -35 }, { 0,0 }, 1, 1, FRICTION_COEFFICIENTS, 0.01f, 0.1f, { 0,0,1,1 }, true));
+	pScene->AddActor(new Box({ 5,5 }, { 80, -50 }, { -20,0 }, 1, 1, FRICTION_COEFFICIENTS, 0.01f, 0.01f, { 0,0,1,1 }, true));
+	pScene->AddActor(new Sphere(vec2(0, 40), vec2(20, 0), 0, 4.0f, 1, FRICTION_COEFFICIENTS, 0.01f, 0.1f, 4, vec4(1, 0, 0, 1)));
+	pScene->AddActor(new Sphere(vec2(0, -20), vec2(0, 0), 0, 4.0f, 1, FRICTION_COEFFICIENTS, 0.01f, 0.1f, 4, vec4(0, 1, 0, 1)));
+
+	vector<vec2> polyVerts = { vec2(-15, 0), vec2(-5, 10), vec2(5, 10), vec2(15, 0), vec2(5, -10), vec2(-5, -10) };
+	pScene->AddActor(new Poly(polyVerts, { 30,-40 }, { 0,10 }, 0.0f, 0, 1, 1, FRICTION_COEFFICIENTS, 0.01f, 0.1f, vec4(1, 0, 0, 1)));
+
+	vector<vector<vec2>> stitchedVerts =
+	{
+		{vec2(-10, 10), vec2(0, 5), vec2(0,0), vec2(-5, 0)},
+		{vec2(10, 10), vec2(5, 0), vec2(0,0), vec2(0, 5)},
+		{vec2(10, -10), vec2(0, -5), vec2(0,0), vec2(5, 0)},
+		{vec2(-10, -10), vec2(-5, 0), vec2(0,0), vec2(0, -5)}
+	};
+	pScene->AddActor(new Stitched(stitchedVerts, { 0,0 }, { 0,0 }, 0.5f, 0, FLT_MAX, 1, FRICTION_COEFFICIENTS, 0.01f, 0.1f, { 1,1,0,1 }));
+	pScene->AddActor(new Stitched(stitchedVerts, { 40,40 }, { 10,10 }, 0.0f, 0, 1, 1, FRICTION_COEFFICIENTS, 0.01f, 0.1f, { .5,0,.5,1 }));
+
+	return pScene;
+}
+
+static void RunUpdates(PhysicsScene* pScene)
+{
+	for (int frame = 0; frame < AllocGuard::WARMUP_UPDATES + GUARDED_FRAMES; ++frame)
+		pScene->Update(FRAME_TIME);
+}
+
+int RunAllocGuardTest()
+{
+	aie::JobSystem jobs(2);
+
+	PhysicsScene* pScene = MakeScene(jobs);
+	RunUpdates(pScene);
+	delete pScene;
+	printf("AllocGuard: synchronous updates passed\n");
+
+	// The main thread's allocations while the worker steps are not the scene's
+	pScene = MakeScene(jobs);
+	std::string frameText;
+	for (int frame = 0; frame < AllocGuard::WARMUP_UPDATES + GUARDED_FRAMES; ++frame)
+	{
+		pScene->EndStep();
+		pScene->BeginStep(FRAME_TIME);
+		frameText = "frame " + std::to_string(frame) + std::string(64, '.');
+	}
+	pScene->EndStep();
+	delete pScene;
+	printf("AllocGuard: asynchronous steps passed\n");
+
+	// Each scene's guard counts only its own steps, on the workers they share
+	PhysicsScene* pFirst = MakeScene(jobs);
+	PhysicsScene* pSecond = MakeScene(jobs);
+	std::thread second(RunUpdates, pSecond);
+	RunUpdates(pFirst);
+	second.join();
+	delete pFirst;
+	delete pSecond;
+	printf("AllocGuard: concurrent scenes passed\n");
+
+	return 0;
+}
+
+#endif
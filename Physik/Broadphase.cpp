@@ -0,0 +1,120 @@
+#include "Broadphase.h"
+#include <algorithm>
+
+void Broadphase::Build(vector<PhysicsObject*> const& actors)
+{
+	m_Nodes.clear();
+	m_Leaves.clear();
+	m_Unbounded.clear();
+	m_ActorBounds.resize(actors.size());
+	m_ActorFilters.resize(actors.size());
+
+	for (int i = 0; i < (int)actors.size(); ++i)
+	{
+		m_ActorBounds[i] = actors[i]->GetBounds();
+		m_ActorFilters[i] = actors[i]->GetCollisionFilter();
+		if (actors[i]->getShapeID() != ShapeID::Plane)
+			m_Leaves.push_back(i);
+		else
+			m_Unbounded.push_back(i);
+	}
+
+	if (m_Leaves.empty())
+		return;
+
+	m_Nodes.reserve(m_Leaves.size() * 2);
+	BuildNode(0, (int)m_Leaves.size());
+}
+
+void Broadphase::Reserve(int actorCount)
+{
+	m_Nodes.reserve(actorCount * 2);
+	m_Leaves.reserve(actorCount);
+	m_Unbounded.reserve(actorCount);
+	m_ActorBounds.reserve(actorCount);
+	m_ActorFilters.reserve(actorCount);
+}
+
+void Broadphase::Refit(vector<PhysicsObject*> const& actors)
+{
+	for (int i = 0; i < (int)m_ActorBounds.size(); ++i)
+		m_ActorBounds[i] = actors[i]->GetBounds();
+
+	// Children are always built after their parent, so walking backwards
+	// refits every child before the node that holds it
+	for (int i = (int)m_Nodes.size() - 1; i >= 0; --i)
+	{
+		Node& node = m_Nodes[i];
+		if (node.actor >= 0)
+		{
+			node.bounds = m_ActorBounds[node.actor];
+			continue;
+		}
+
+		Bounds const& left = m_Nodes[node.left].bounds;
+		Bounds const& right = m_Nodes[node.right].bounds;
+		node.bounds.min = glm::min(left.min, right.min);
+		node.bounds.max = glm::max(left.max, right.max);
+	}
+}
+
+void Broadphase::FindPairs(vector<BroadphasePair>& pairs) const
+{
+	for (int i = 0; i < (int)m_Leaves.size(); ++i)
+	{
+		int actor = m_Leaves[i];
+		CollisionFilter const& filter = m_ActorFilters[actor];
+
+		// An actor that collides with nothing needn't walk the tree
+		if (filter.uMask == 0 || filter.uCategory == 0)
+			continue;
+
+		QueryBounds(m_ActorBounds[actor], [&](int other)
+		{
+			// each pair is found from both ends, keep one
+			if (other > actor && ShouldCollide(filter, m_ActorFilters[other]))
+				pairs.push_back({ actor, other });
+		});
+	}
+}
+
+int Broadphase::BuildNode(int first, int count)
+{
+	int nodeIndex = (int)m_Nodes.size();
+	m_Nodes.push_back(Node());
+
+	Bounds bounds = m_ActorBounds[m_Leaves[first]];
+	for (int i = first + 1; i < first + count; ++i)
+	{
+		Bounds const& leafBounds = m_ActorBounds[m_Leaves[i]];
+		bounds.min = glm::min(bounds.min, leafBounds.min);
+		bounds.max = glm::max(bounds.max, leafBounds.max);
+	}
+
+	if (count == 1)
+	{
+		Node& node = m_Nodes[nodeIndex];
+		node.bounds = bounds;
+		node.actor = m_Leaves[first];
+		return nodeIndex;
+	}
+
+	// Median split along the longest side
+	int axis = (bounds.max.x - bounds.min.x >= bounds.max.y - bounds.min.y) ? 0 : 1;
+	int half = count / 2;
+	auto begin = m_Leaves.begin() + first;
+	std::nth_element(begin, begin + half, begin + count, [&](int a, int b)
+	{
+		return m_ActorBounds[a].min[axis] + m_ActorBounds[a].max[axis] <
+			m_ActorBounds[b].min[axis] + m_ActorBounds[b].max[axis];
+	});
+
+	int left = BuildNode(first, half);
+	int right = BuildNode(first + half, count - half);
+
+	Node& node = m_Nodes[nodeIndex];
+	node.bounds = bounds;
+	node.left = left;
+	node.right = right;
+	return nodeIndex;
+}
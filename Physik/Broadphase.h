@@ -0,0 +1,255 @@
+#pragma once
+#include <vector>
+#include "PhysicsObject.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define PHYSIK_SSE
+#include <emmintrin.h>
+#endif
+
+using std::vector;
+
+// Two actors whose bounds overlap, by index into the scene's actors (a < b)
+struct BroadphasePair
+{
+	int a;
+	int b;
+};
+
+/***
+ * @brief Rays traversed together, one per SIMD lane. A lane with a negative
+ *			fMaxDistance is empty and never hits.
+ */
+struct RayPacket
+{
+	static const int SIZE = 4;
+
+	float originX[SIZE];
+	float originY[SIZE];
+	// reciprocal unit direction, zero components are a large finite value so
+	// the slab test needs no special case
+	float invDirX[SIZE];
+	float invDirY[SIZE];
+	float maxDistance[SIZE];
+};
+
+/***
+ * @brief Bounding volume hierarchy over actor bounds, rebuilt every step.
+ *			Unbounded actors (planes) are left out of the tree.
+ */
+class Broadphase
+{
+public:
+	struct Node
+	{
+		Bounds bounds;
+		// children are only valid when actor is -1
+		int left = -1;
+		int right = -1;
+		int actor = -1;
+	};
+
+	/***
+	 * @brief Rebuilds the tree from the current bounds of every actor
+	 */
+	void Build(vector<PhysicsObject*> const& actors);
+
+	/***
+	 * @brief Sizes the tree's storage for a number of actors
+	 */
+	void Reserve(int actorCount);
+
+	/***
+	 * @brief Updates the tree's bounds from the actors without changing its
+	 *			shape. The actors must be the ones it was built from.
+	 */
+	void Refit(vector<PhysicsObject*> const& actors);
+
+	/***
+	 * @brief Appends every pair of actors in the tree whose bounds overlap and
+	 *			whose collision filters let them collide
+	 */
+	void FindPairs(vector<BroadphasePair>& pairs) const;
+
+	/***
+	 * @brief Calls func(actorIndex) for every actor in the tree whose bounds
+	 *			overlap a box
+	 */
+	template <class F>
+	void QueryBounds(Bounds const& bounds, F&& func) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		int stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			Node const& node = m_Nodes[stack[--stackSize]];
+			if (!BoundsOverlap(node.bounds, bounds))
+				continue;
+
+			if (node.actor >= 0)
+			{
+				func(node.actor);
+			}
+			else
+			{
+				stack[stackSize++] = node.left;
+				stack[stackSize++] = node.right;
+			}
+		}
+	}
+
+	/***
+	 * @brief Calls func(actorIndex) for every actor in the tree whose bounds
+	 *			the segment origin + direction * t, 0 <= t <= fMaxDistance,
+	 *			crosses. func returns the distance to keep searching to, so a
+	 *			closest hit query shortens the segment as it finds hits.
+	 */
+	template <class F>
+	void QueryRay(glm::vec2 const& origin, glm::vec2 const& direction, float fMaxDistance, F&& func) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		int stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			Node const& node = m_Nodes[stack[--stackSize]];
+			if (!RayHitsBounds(node.bounds, origin, direction, fMaxDistance))
+				continue;
+
+			if (node.actor >= 0)
+			{
+				fMaxDistance = func(node.actor);
+			}
+			else
+			{
+				stack[stackSize++] = node.left;
+				stack[stackSize++] = node.right;
+			}
+		}
+	}
+
+	/***
+	 * @brief Calls func(actorIndex, laneMask) for every actor in the tree whose
+	 *			bounds any ray in the packet crosses, laneMask has a bit set for
+	 *			each of those rays. func may shorten the packet's rays.
+	 */
+	template <class F>
+	void QueryRayPacket(RayPacket& packet, F&& func) const
+	{
+		if (m_Nodes.empty())
+			return;
+
+		int stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			Node const& node = m_Nodes[stack[--stackSize]];
+			int laneMask = PacketHitsBounds(node.bounds, packet);
+			if (laneMask == 0)
+				continue;
+
+			if (node.actor >= 0)
+			{
+				func(node.actor, laneMask);
+			}
+			else
+			{
+				stack[stackSize++] = node.left;
+				stack[stackSize++] = node.right;
+			}
+		}
+	}
+
+	// Slab test for every lane at once, returns a bit per lane that hits
+	static inline int PacketHitsBounds(Bounds const& bounds, RayPacket const& packet)
+	{
+#ifdef PHYSIK_SSE
+		__m128 maxDistance = _mm_loadu_ps(packet.maxDistance);
+
+		__m128 originX = _mm_loadu_ps(packet.originX);
+		__m128 invDirX = _mm_loadu_ps(packet.invDirX);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.x), originX), invDirX);
+		__m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.max.x), originX), invDirX);
+		__m128 tMin = _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(t1, t2));
+		__m128 tMax = _mm_min_ps(maxDistance, _mm_max_ps(t1, t2));
+
+		__m128 originY = _mm_loadu_ps(packet.originY);
+		__m128 invDirY = _mm_loadu_ps(packet.invDirY);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.min.y), originY), invDirY);
+		t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bounds.max.y), originY), invDirY);
+		tMin = _mm_max_ps(tMin, _mm_min_ps(t1, t2));
+		tMax = _mm_min_ps(tMax, _mm_max_ps(t1, t2));
+
+		return _mm_movemask_ps(_mm_cmple_ps(tMin, tMax));
+#else
+		int laneMask = 0;
+		for (int lane = 0; lane < RayPacket::SIZE; ++lane)
+		{
+			float t1 = (bounds.min.x - packet.originX[lane]) * packet.invDirX[lane];
+			float t2 = (bounds.max.x - packet.originX[lane]) * packet.invDirX[lane];
+			float tMin = glm::max(0.0f, glm::min(t1, t2));
+			float tMax = glm::min(packet.maxDistance[lane], glm::max(t1, t2));
+
+			t1 = (bounds.min.y - packet.originY[lane]) * packet.invDirY[lane];
+			t2 = (bounds.max.y - packet.originY[lane]) * packet.invDirY[lane];
+			tMin = glm::max(tMin, glm::min(t1, t2));
+			tMax = glm::min(tMax, glm::max(t1, t2));
+
+			if (tMin <= tMax)
+				laneMask |= 1 << lane;
+		}
+		return laneMask;
+#endif
+	}
+
+	// Slab test, a zero direction component only needs the origin in that slab
+	static inline bool RayHitsBounds(Bounds const& bounds, glm::vec2 const& origin, glm::vec2 const& direction, float fMaxDistance)
+	{
+		float tMin = 0;
+		float tMax = fMaxDistance;
+
+		for (int axis = 0; axis < 2; ++axis)
+		{
+			if (direction[axis] == 0)
+			{
+				if (origin[axis] < bounds.min[axis] || origin[axis] > bounds.max[axis])
+					return false;
+				continue;
+			}
+
+			float invDir = 1.0f / direction[axis];
+			float t1 = (bounds.min[axis] - origin[axis]) * invDir;
+			float t2 = (bounds.max[axis] - origin[axis]) * invDir;
+			tMin = glm::max(tMin, glm::min(t1, t2));
+			tMax = glm::min(tMax, glm::max(t1, t2));
+		}
+
+		return tMin <= tMax;
+	}
+
+	inline vector<Node> const& GetNodes() const { return m_Nodes; };
+	// Actors left out of the tree, tested on their own
+	inline vector<int> const& GetUnbounded() const { return m_Unbounded; };
+
+private:
+	int BuildNode(int first, int count);
+
+	vector<Node> m_Nodes;
+	// actor indices in the tree, reordered while building
+	vector<int> m_Leaves;
+	vector<int> m_Unbounded;
+	// bounds and filters of every actor, indexed like the scene's actors
+	vector<Bounds> m_ActorBounds;
+	vector<CollisionFilter> m_ActorFilters;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/***
+ * @brief Bounded lock-free queue for many producer threads and one consumer.
+ *			Each slot carries a sequence number that says whether it is free
+ *			to write or ready to read, so producers only contend on the tail.
+ *
+ * Nothing is allocated after construction. Push fails when the queue is full.
+ */
+template <class T>
+class CommandQueue
+{
+public:
+	CommandQueue(int capacity = 4096)
+	{
+		int size = 16;
+		while (size < capacity)
+			size <<= 1;
+
+		m_mask = (uint32_t)size - 1;
+		m_Slots.reset(new Slot[size]);
+		for (int i = 0; i < size; ++i)
+			m_Slots[i].sequence.store((uint32_t)i, std::memory_order_relaxed);
+	}
+
+	/***
+	 * @brief Adds a value from any thread
+	 * @return false if the queue is full
+	 */
+	bool Push(T const& value)
+	{
+		uint32_t pos = m_tail.load(std::memory_order_relaxed);
+		Slot* pSlot;
+
+		while (true)
+		{
+			pSlot = &m_Slots[pos & m_mask];
+			uint32_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+			int32_t diff = (int32_t)(sequence - pos);
+
+			if (diff == 0)
+			{
+				// the slot is free, claim it by moving the tail past it
+				if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				// the consumer has not read this slot from the last lap yet
+				return false;
+			}
+			else
+			{
+				pos = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		pSlot->value = value;
+		pSlot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/***
+	 * @brief Takes the oldest value, only ever call from the consumer thread
+	 * @return false if the queue is empty
+	 */
+	bool Pop(T& value)
+	{
+		Slot& slot = m_Slots[m_head & m_mask];
+		uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if ((int32_t)(sequence - (m_head + 1)) < 0)
+			return false;
+
+		value = slot.value;
+		// free the slot for the producers' next lap
+		slot.sequence.store(m_head + m_mask + 1, std::memory_order_release);
+		++m_head;
+		return true;
+	}
+
+	inline int GetCapacity() const { return (int)m_mask + 1; };
+
+private:
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence;
+		T value;
+	};
+
+	std::unique_ptr<Slot[]> m_Slots;
+	uint32_t m_mask;
+
+	std::atomic<uint32_t> m_tail = { 0 };
+	// only touched by the consumer
+	uint32_t m_head = 0;
+};
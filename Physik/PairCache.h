@@ -0,0 +1,217 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+using std::vector;
+
+/***
+ * @brief Open addressed table of data that persists for an actor pair
+ *			between steps. Keyed by the ordered pair of actor IDs (a, b), which
+ *			a scene never hands out twice, so a removed actor's entries can't
+ *			be picked up by whatever is added after it.
+ *
+ * Entries not touched for a step are flushed by BeginStep() when the table
+ *	fills up, so the storage only grows while the number of live pairs grows.
+ */
+template <class T>
+class PairCache
+{
+public:
+	struct Entry
+	{
+		// 0 marks an empty slot, no actor in a scene has ID 0
+		uint32_t uA = 0;
+		uint32_t uB = 0;
+		unsigned int uLastStep = 0;
+		T data;
+	};
+
+	PairCache(int capacity = 256)
+	{
+		int size = 16;
+		while (size < capacity)
+			size <<= 1;
+
+		m_Entries.resize(size);
+		m_Scratch.resize(size);
+	}
+
+	/***
+	 * @brief Advances the step counter. Flushes entries that were not touched
+	 *			last step once the table is half full, growing it if needed.
+	 */
+	void BeginStep()
+	{
+		++m_uStep;
+
+		if (m_count * 2 < (int)m_Entries.size())
+			return;
+
+		Rebuild(m_uStep - 1);
+
+		if (m_count * 2 >= (int)m_Entries.size())
+		{
+			m_Scratch.resize(m_Entries.size() * 2);
+			Rebuild(m_uStep - 1);
+			m_Scratch.resize(m_Entries.size());
+		}
+	}
+
+	/***
+	 * @brief Finds the data for a pair, or nullptr if it has none
+	 */
+	T* Find(uint32_t uA, uint32_t uB)
+	{
+		int mask = (int)m_Entries.size() - 1;
+		for (int i = Hash(uA, uB) & mask;; i = (i + 1) & mask)
+		{
+			Entry& entry = m_Entries[i];
+			if (entry.uA == 0)
+				return nullptr;
+
+			if (entry.uA == uA && entry.uB == uB)
+			{
+				entry.uLastStep = m_uStep;
+				return &entry.data;
+			}
+		}
+	}
+
+	/***
+	 * @brief Finds the data for a pair, adding a default entry if it has none
+	 */
+	T& FindOrAdd(uint32_t uA, uint32_t uB)
+	{
+		// Keep the table at most 3/4 full so probes stay short
+		if ((m_count + 1) * 4 > (int)m_Entries.size() * 3)
+		{
+			m_Scratch.resize(m_Entries.size() * 2);
+			Rebuild(0);
+			m_Scratch.resize(m_Entries.size());
+		}
+
+		int mask = (int)m_Entries.size() - 1;
+		for (int i = Hash(uA, uB) & mask;; i = (i + 1) & mask)
+		{
+			Entry& entry = m_Entries[i];
+			if (entry.uA == 0)
+			{
+				entry.uA = uA;
+				entry.uB = uB;
+				entry.data = T();
+				++m_count;
+			}
+
+			if (entry.uA == uA && entry.uB == uB)
+			{
+				entry.uLastStep = m_uStep;
+				return entry.data;
+			}
+		}
+	}
+
+	/***
+	 * @brief Grows the table so it holds count pairs without growing again
+	 */
+	void Reserve(int count)
+	{
+		int size = (int)m_Entries.size();
+		while (count * 4 > size * 3)
+			size <<= 1;
+
+		if (size == (int)m_Entries.size())
+			return;
+
+		m_Scratch.resize(size);
+		Rebuild(0);
+		m_Scratch.resize(size);
+	}
+
+	/***
+	 * @brief Removes every entry, keeping the storage
+	 */
+	void Clear()
+	{
+		for (int i = 0; i < (int)m_Entries.size(); ++i)
+			m_Entries[i] = Entry();
+		m_count = 0;
+	}
+
+	inline int GetCount() const { return m_count; };
+
+	// A copy of the whole table, entries are plain data
+	struct Snapshot
+	{
+		vector<Entry> entries;
+		int count = 0;
+		unsigned int uStep = 0;
+	};
+
+	/***
+	 * @brief Copies the table into a snapshot, or back from one. Neither
+	 *			allocates unless the table has grown since the snapshot's
+	 *			storage was last sized.
+	 */
+	void Save(Snapshot& snapshot) const
+	{
+		snapshot.entries = m_Entries;
+		snapshot.count = m_count;
+		snapshot.uStep = m_uStep;
+	}
+
+	void Restore(Snapshot const& snapshot)
+	{
+		m_Entries = snapshot.entries;
+		if (m_Scratch.size() != m_Entries.size())
+			m_Scratch.resize(m_Entries.size());
+		m_count = snapshot.count;
+		m_uStep = snapshot.uStep;
+	}
+
+	// Sizes a snapshot's storage to hold the table as it is now
+	void ReserveSnapshot(Snapshot& snapshot) const { snapshot.entries.reserve(m_Entries.size()); };
+
+private:
+	static unsigned int Hash(uint32_t uA, uint32_t uB)
+	{
+		uint64_t a = uA;
+		uint64_t b = uB;
+
+		uint64_t h = (a * 0x9E3779B97F4A7C15ull) ^ (b + 0x7F4A7C159E3779B9ull + (a << 6) + (a >> 2));
+		h ^= h >> 29;
+		return (unsigned int)h;
+	}
+
+	/***
+	 * @brief Moves every entry touched on or after uOldestStep into m_Scratch,
+	 *			then swaps it in as the table
+	 */
+	void Rebuild(unsigned int uOldestStep)
+	{
+		for (int i = 0; i < (int)m_Scratch.size(); ++i)
+			m_Scratch[i] = Entry();
+
+		int mask = (int)m_Scratch.size() - 1;
+		m_count = 0;
+		for (int i = 0; i < (int)m_Entries.size(); ++i)
+		{
+			Entry const& entry = m_Entries[i];
+			if (entry.uA == 0 || entry.uLastStep < uOldestStep)
+				continue;
+
+			int j = Hash(entry.uA, entry.uB) & mask;
+			while (m_Scratch[j].uA != 0)
+				j = (j + 1) & mask;
+
+			m_Scratch[j] = entry;
+			++m_count;
+		}
+
+		m_Entries.swap(m_Scratch);
+	}
+
+	vector<Entry> m_Entries;
+	vector<Entry> m_Scratch;
+	int m_count = 0;
+	unsigned int m_uStep = 1;
+};
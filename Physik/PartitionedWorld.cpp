@@ -0,0 +1,256 @@
+#include "PartitionedWorld.h"
+#include "PhysicsScene.h"
+#include "RigidBody.h"
+#include "Plane.h"
+#include "Sphere.h"
+#include "Box.h"
+#include "Poly.h"
+#include "Stitched.h"
+#include <algorithm>
+#include <cassert>
+
+PartitionedWorld::PartitionedWorld(vec2 origin, vec2 regionSize, int columns, int rows, float fHalo, aie::JobSystem& jobs) :
+	m_Jobs(jobs), m_Origin(origin), m_RegionSize(regionSize), m_iColumns(std::max(columns, 1)), m_iRows(std::max(rows, 1))
+{
+	// Ghosts only come from the adjacent regions, a wider halo would miss
+	// bodies two or more regions away
+	float fMaxHalo = std::min(regionSize.x, regionSize.y);
+	assert(fHalo <= fMaxHalo && "PartitionedWorld halo is wider than a region");
+	m_fHalo = std::min(fHalo, fMaxHalo);
+
+	m_Regions.resize(m_iColumns * m_iRows);
+	for (int row = 0; row < m_iRows; ++row)
+	{
+		for (int column = 0; column < m_iColumns; ++column)
+		{
+			Region& region = m_Regions[row * m_iColumns + column];
+			region.pScene = new PhysicsScene();
+			region.column = column;
+			region.row = row;
+
+			// No workers, the step graph runs on whichever thread steps the region
+			region.pJobs.reset(new aie::JobSystem(0));
+			region.pScene->SetJobSystem(region.pJobs.get());
+
+			// Outer regions own everything past the grid's edge
+			vec2 min = m_Origin + vec2(column, row) * m_RegionSize;
+			vec2 max = min + m_RegionSize;
+			region.halo.min.x = column == 0 ? -FLT_MAX : min.x - m_fHalo;
+			region.halo.min.y = row == 0 ? -FLT_MAX : min.y - m_fHalo;
+			region.halo.max.x = column == m_iColumns - 1 ? FLT_MAX : max.x + m_fHalo;
+			region.halo.max.y = row == m_iRows - 1 ? FLT_MAX : max.y + m_fHalo;
+		}
+	}
+}
+
+PartitionedWorld::~PartitionedWorld()
+{
+	// Each scene deletes its own bodies, ghosts and planes
+	for (Region& region : m_Regions)
+		delete region.pScene;
+}
+
+void PartitionedWorld::setGravity(vec2 const& gravity)
+{
+	for (Region& region : m_Regions)
+		region.pScene->setGravity(gravity);
+}
+
+void PartitionedWorld::setTimeStep(float timeStep)
+{
+	for (Region& region : m_Regions)
+		region.pScene->setTimeStep(timeStep);
+}
+
+void PartitionedWorld::AddPlane(vec2 const& normal, float distance, float fFricCoStatic, float fFricCoDynamic)
+{
+	for (Region& region : m_Regions)
+		region.pScene->AddActor(new Plane(normal, distance, fFricCoStatic, fFricCoDynamic));
+}
+
+void PartitionedWorld::AddBody(RigidBody* pBody)
+{
+	Region& region = m_Regions[GetRegionIndex(pBody->getPosition())];
+	region.pScene->AddActor(pBody);
+	region.bodies.push_back(pBody);
+}
+
+int PartitionedWorld::GetRegionIndex(vec2 const& position) const
+{
+	vec2 cell = floor((position - m_Origin) / m_RegionSize);
+	int column = (int)clamp(cell.x, 0.0f, (float)(m_iColumns - 1));
+	int row = (int)clamp(cell.y, 0.0f, (float)(m_iRows - 1));
+	return row * m_iColumns + column;
+}
+
+int PartitionedWorld::GetBodyCount() const
+{
+	int count = 0;
+	for (Region const& region : m_Regions)
+		count += (int)region.bodies.size();
+	return count;
+}
+
+void PartitionedWorld::Step(int stepCount)
+{
+	m_iMigrations = 0;
+
+	for (int step = 0; step < stepCount; ++step)
+	{
+		++m_uExchange;
+
+		// A region only writes its own scene and ghosts, and reads its
+		// neighbours' owned bodies, which nothing moves until the regions step
+		m_Jobs.parallelFor(0, (int)m_Regions.size(), 1, [this](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				ExchangeGhosts(m_Regions[i]);
+		});
+
+		m_Jobs.parallelFor(0, (int)m_Regions.size(), 1, [this](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				m_Regions[i].pScene->Step();
+		});
+
+		MigrateBodies();
+	}
+}
+
+void PartitionedWorld::ExchangeGhosts(Region& region)
+{
+	BodySnapshot snapshot;
+
+	for (int row = region.row - 1; row <= region.row + 1; ++row)
+	{
+		for (int column = region.column - 1; column <= region.column + 1; ++column)
+		{
+			if (row < 0 || row >= m_iRows || column < 0 || column >= m_iColumns ||
+				(row == region.row && column == region.column))
+				continue;
+
+			for (RigidBody* pSource : m_Regions[row * m_iColumns + column].bodies)
+			{
+				if (!BoundsOverlap(pSource->GetBounds(), region.halo))
+					continue;
+
+				auto found = region.ghosts.find(pSource);
+				if (found == region.ghosts.end())
+				{
+					RigidBody* pGhost = CloneBody(pSource);
+					region.pScene->AddActor(pGhost);
+					found = region.ghosts.emplace(pSource, Ghost{ pGhost, 0 }).first;
+				}
+
+				// Overwrites whatever the ghost did last step
+				pSource->SaveSnapshot(snapshot);
+				found->second.pBody->LoadSnapshot(snapshot);
+				found->second.uStamp = m_uExchange;
+			}
+		}
+	}
+
+	// Drop ghosts whose source left the halo or migrated into this region
+	for (auto it = region.ghosts.begin(); it != region.ghosts.end();)
+	{
+		if (it->second.uStamp == m_uExchange)
+		{
+			++it;
+			continue;
+		}
+
+		region.pScene->RemoveActor(it->second.pBody);
+		delete it->second.pBody;
+		it = region.ghosts.erase(it);
+	}
+}
+
+void PartitionedWorld::MigrateBodies()
+{
+	// Serial, so bodies leave and arrive in region and body order
+	for (int i = 0; i < (int)m_Regions.size(); ++i)
+	{
+		vector<RigidBody*>& bodies = m_Regions[i].bodies;
+
+		int kept = 0;
+		for (int j = 0; j < (int)bodies.size(); ++j)
+		{
+			RigidBody* pBody = bodies[j];
+			int target = GetRegionIndex(pBody->getPosition());
+			if (target == i)
+			{
+				bodies[kept++] = pBody;
+				continue;
+			}
+
+			// A ghost of it in the target is dropped at the next exchange
+			m_Regions[i].pScene->RemoveActor(pBody);
+			m_Regions[target].pScene->AddActor(pBody);
+			m_Regions[target].bodies.push_back(pBody);
+			++m_iMigrations;
+		}
+		bodies.resize(kept);
+	}
+}
+
+void PartitionedWorld::UpdateGizmos()
+{
+	for (PhysicsObject* pActor : m_Regions[0].pScene->GetActors())
+	{
+		if (pActor->getShapeID() == ShapeID::Plane)
+			pActor->makeGizmo();
+	}
+
+	for (Region const& region : m_Regions)
+	{
+		for (RigidBody* pBody : region.bodies)
+			pBody->DrawGizmo(pBody->GetState());
+	}
+}
+
+RigidBody* PartitionedWorld::CloneBody(RigidBody* pBody)
+{
+	vec2 position = pBody->getPosition();
+	vec2 velocity = pBody->getVelocity();
+	float fFricCoStatic = pBody->GetStaticFricCo();
+	float fFricCoDynamic = pBody->GetKineticFricCo();
+
+	RigidBody* pClone = nullptr;
+	switch (pBody->getShapeID())
+	{
+	case ShapeID::Sphere:
+	{
+		Sphere* pSphere = (Sphere*)pBody;
+		pClone = new Sphere(position, velocity, pBody->getAngularVelocity(), pBody->getMass(), pBody->getElasticity(),
+			fFricCoStatic, fFricCoDynamic, pBody->getDrag(), pBody->getAngularDrag(), pSphere->getRadius(), pSphere->getColour());
+		break;
+	}
+	case ShapeID::Box:
+	{
+		Box* pBox = (Box*)pBody;
+		pClone = new Box(pBox->getExtents(), position, velocity, pBody->getMass(), pBody->getElasticity(),
+			fFricCoStatic, fFricCoDynamic, pBody->getDrag(), pBody->getAngularDrag(), pBox->getColour(), pBody->GetIsFilled());
+		break;
+	}
+	case ShapeID::Poly:
+	{
+		Poly* pPoly = (Poly*)pBody;
+		pClone = new Poly(pPoly->GetGeometry(), position, velocity, pBody->getRotation(), pBody->getAngularVelocity(), pBody->getMass(),
+			pBody->getElasticity(), fFricCoStatic, fFricCoDynamic, pBody->getDrag(), pBody->getAngularDrag(), pPoly->GetColour());
+		break;
+	}
+	case ShapeID::Stitched:
+	{
+		Stitched* pStitched = (Stitched*)pBody;
+		pClone = new Stitched(pStitched->GetGeometry(), position, velocity, pBody->getRotation(), pBody->getAngularVelocity(), pBody->getMass(),
+			pBody->getElasticity(), fFricCoStatic, fFricCoDynamic, pBody->getDrag(), pBody->getAngularDrag(), pStitched->GetColour());
+		break;
+	}
+	default:
+		return nullptr;
+	}
+
+	pClone->SetCollisionFilter(pBody->GetCollisionFilter());
+	pClone->SetSensor(pBody->IsSensor());
+	return pClone;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <glm/ext.hpp>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <JobSystem.h>
+#include "PhysicsObject.h"
+
+using namespace glm;
+using std::vector;
+
+class PhysicsScene;
+class RigidBody;
+
+/***
+ * @brief Splits the plane into a grid of regions, each its own scene stepped
+ *			by one job. A region owns the bodies whose centres lie in it and
+ *			holds ghost copies of its neighbours' bodies within a halo of its
+ *			edge, so bodies collide across region boundaries.
+ *
+ * Each step the ghosts are refreshed from the bodies they copy, every region
+ *	steps, then bodies whose centres left their region migrate to the one
+ *	they are now in. A ghost's own result is thrown away at the next refresh,
+ *	only the owned body on each side of a contact keeps its response. The halo
+ *	should be at least the largest body radius plus the furthest a body moves
+ *	in a step, and at most the shorter side of a region, since ghosts only
+ *	come from the adjacent regions. A wider halo is clamped to that. The
+ *	outer regions reach out to infinity.
+ */
+class PartitionedWorld
+{
+public:
+	PartitionedWorld(vec2 origin, vec2 regionSize, int columns, int rows, float fHalo, aie::JobSystem& jobs = aie::JobSystem::getDefault());
+	~PartitionedWorld();
+
+	void setGravity(vec2 const& gravity);
+	void setTimeStep(float timeStep);
+
+	// Adds a plane to every region
+	void AddPlane(vec2 const& normal, float distance, float fFricCoStatic, float fFricCoDynamic);
+	// The world takes ownership, the body goes to the region its centre is in
+	void AddBody(RigidBody* pBody);
+
+	// Runs stepCount fixed steps of every region, returning when all are done
+	void Step(int stepCount = 1);
+
+	// Draws every owned body at its current pose, and the planes once
+	void UpdateGizmos();
+
+	inline int GetRegionCount() const { return (int)m_Regions.size(); };
+	inline PhysicsScene* GetRegion(int index) const { return m_Regions[index].pScene; };
+	// bodies the region steps for the world, not its ghosts
+	inline vector<RigidBody*> const& GetRegionBodies(int index) const { return m_Regions[index].bodies; };
+	inline int GetRegionGhostCount(int index) const { return (int)m_Regions[index].ghosts.size(); };
+	int GetRegionIndex(vec2 const& position) const;
+
+	int GetBodyCount() const;
+	// bodies that changed region during the last Step
+	inline int GetMigrationCount() const { return m_iMigrations; };
+
+private:
+	struct Ghost
+	{
+		RigidBody* pBody;
+		// the exchange that last found its source in the halo
+		uint32_t uStamp;
+	};
+
+	struct Region
+	{
+		PhysicsScene* pScene;
+		std::unique_ptr<aie::JobSystem> pJobs;
+		// the area it owns grown by the halo
+		Bounds halo;
+		int column;
+		int row;
+		vector<RigidBody*> bodies;
+		// keyed by the neighbour's body each one copies
+		std::unordered_map<RigidBody const*, Ghost> ghosts;
+	};
+
+	// Refreshes a region's ghosts from its neighbours' bodies, reading only
+	// their owned bodies so every region can exchange at once
+	void ExchangeGhosts(Region& region);
+	// Moves bodies whose centres have left their region, after every region stepped
+	void MigrateBodies();
+
+	// A new body of the same shape, material and filter, its state is set by the exchange
+	static RigidBody* CloneBody(RigidBody* pBody);
+
+	aie::JobSystem& m_Jobs;
+	vector<Region> m_Regions;
+
+	vec2 m_Origin;
+	vec2 m_RegionSize;
+	int m_iColumns;
+	int m_iRows;
+	float m_fHalo;
+
+	uint32_t m_uExchange = 0;
+	int m_iMigrations = 0;
+};
@@ -1,37 +1,99 @@
-#pragma once
-#include <glm/ext.hpp>
-
-enum class ShapeID : int
-{
-	Plane = 0,
-	Sphere,
-	Box,
-	Poly,
-	Stitched,
-
-	TOTAL
-};
-
-class PhysicsObject
-{
-public:
-	inline virtual ~PhysicsObject() {};
-
-	virtual void fixedUpdate(glm::vec2 const& gravity, float timeStep) = 0;
-	virtual void debug() = 0;
-	virtual void makeGizmo() = 0;
-	virtual void resetPosition() {};
-
-	inline ShapeID getShapeID() { return m_ShapeId; };
-	inline float GetStaticFricCo() const { return m_fFricCoStatic; };
-	inline float GetKineticFricCo() const { return m_fFricCoKinetic; };
-
-protected:
-	inline PhysicsObject(ShapeID shapeID, float fFricCoStatic, float fFricCoDynamic) 
-		: m_ShapeId(shapeID), m_fFricCoStatic(fFricCoStatic), m_fFricCoKinetic(fFricCoDynamic) {};
-	ShapeID m_ShapeId;
-
-	float m_fFricCoStatic;
-	float m_fFricCoKinetic;
-};
-
+#pragma once
+#include <glm/ext.hpp>
+#include <cstdint>
+
+enum class ShapeID : int
+{
+	Plane = 0,
+	Sphere,
+	Box,
+	Poly,
+	Stitched,
+
+	TOTAL
+};
+
+struct Bounds
+{
+	glm::vec2 min;
+	glm::vec2 max;
+};
+
+inline bool BoundsOverlap(Bounds const& a, Bounds const& b)
+{
+	return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+		a.min.y <= b.max.y && a.max.y >= b.min.y;
+}
+
+/***
+ * @brief Which actors may collide. A pair collides only if each one's
+ *			category is in the other's mask, and they don't share a group.
+ */
+struct CollisionFilter
+{
+	// what an actor is, also tested against a query's layer mask
+	uint32_t uCategory = 1;
+	// the categories it collides with
+	uint32_t uMask = 0xFFFFFFFF;
+	// actors in the same non-zero group never collide, e.g. a projectile and its owner
+	uint32_t uGroup = 0;
+};
+
+inline bool ShouldCollide(CollisionFilter const& a, CollisionFilter const& b)
+{
+	return (a.uCategory & b.uMask) != 0 && (b.uCategory & a.uMask) != 0 &&
+		(a.uGroup == 0 || a.uGroup != b.uGroup);
+}
+
+class PhysicsObject
+{
+public:
+	inline virtual ~PhysicsObject() {};
+
+	virtual void fixedUpdate(glm::vec2 const& gravity, float timeStep) = 0;
+	virtual void debug() = 0;
+	virtual void makeGizmo() = 0;
+	virtual void resetPosition() {};
+	// Recomputes m_Bounds from the current pose
+	virtual void UpdateBounds() {};
+
+	inline ShapeID getShapeID() { return m_ShapeId; };
+	inline float GetStaticFricCo() const { return m_fFricCoStatic; };
+	inline float GetKineticFricCo() const { return m_fFricCoKinetic; };
+	inline Bounds const& GetBounds() const { return m_Bounds; };
+	// Stable ID the scene gives an actor when it is added, 0 until then and once removed
+	inline uint32_t GetID() const { return m_uID; };
+	// Pairs the filter rejects are dropped by the broadphase, they are never tested
+	inline void SetCollisionFilter(CollisionFilter const& filter) { m_Filter = filter; };
+	inline CollisionFilter const& GetCollisionFilter() const { return m_Filter; };
+	inline void SetCategory(uint32_t uCategory) { m_Filter.uCategory = uCategory; };
+	inline uint32_t GetCategory() const { return m_Filter.uCategory; };
+	inline void SetCollisionMask(uint32_t uMask) { m_Filter.uMask = uMask; };
+	inline uint32_t GetCollisionMask() const { return m_Filter.uMask; };
+	inline void SetCollisionGroup(uint32_t uGroup) { m_Filter.uGroup = uGroup; };
+	inline uint32_t GetCollisionGroup() const { return m_Filter.uGroup; };
+	/***
+	 * @brief A sensor finds the actors it overlaps, reported as contact events,
+	 *			but is never resolved against them. Neither is pushed.
+	 */
+	inline void SetSensor(bool bSensor) { m_bSensor = bSensor; };
+	inline bool IsSensor() const { return m_bSensor; };
+
+protected:
+	inline PhysicsObject(ShapeID shapeID, float fFricCoStatic, float fFricCoDynamic) 
+		: m_ShapeId(shapeID), m_fFricCoStatic(fFricCoStatic), m_fFricCoKinetic(fFricCoDynamic) {};
+	ShapeID m_ShapeId;
+
+	float m_fFricCoStatic;
+	float m_fFricCoKinetic;
+
+	// unbounded until a shape says otherwise
+	Bounds m_Bounds = { glm::vec2(-FLT_MAX), glm::vec2(FLT_MAX) };
+	CollisionFilter m_Filter;
+	bool m_bSensor = false;
+
+private:
+	friend class PhysicsScene;
+	uint32_t m_uID = 0;
+};
+
@@ -1,1048 +1,2212 @@
-#include "PhysicsScene.h"
-#include "PhysicsObject.h"
-#include <list>
-#include "RigidBody.h"
-#include <iostream>
-#include "Plane.h"
-#include "Sphere.h"
-#include "Box.h"
-#include "Poly.h"
-#include "Stitched.h"
-
-#define DEBUG_FREQ 5
-
-typedef CollisionInfo(*CollisionTest)(PhysicsObject*, PhysicsObject*);
-
-static CollisionTest collisionFuncs[(int)ShapeID::TOTAL][(int)ShapeID::TOTAL] =
-{ 
-{PhysicsScene::plane2Plane, PhysicsScene::plane2Sphere, PhysicsScene::plane2Box, PhysicsScene::plane2Poly, PhysicsScene::plane2Stitched},
-{PhysicsScene::sphere2Plane, PhysicsScene::sphere2Sphere, PhysicsScene::sphere2Box, PhysicsScene::sphere2Poly, PhysicsScene::sphere2Stitched},
-{PhysicsScene::box2Plane, PhysicsScene::box2Sphere, PhysicsScene::box2Box, PhysicsScene::box2Poly, PhysicsScene::box2Stitched},
-{PhysicsScene::poly2Plane, PhysicsScene::poly2Sphere, PhysicsScene::poly2Box, PhysicsScene::poly2Poly, PhysicsScene::poly2Stitched},
-{PhysicsScene::stitched2Plane, PhysicsScene::stitched2Sphere, PhysicsScene::stitched2Box, PhysicsScene::stitched2Poly, PhysicsScene::stitched2Stitched}
-};
-
-PhysicsScene::PhysicsScene()
-{
-	m_timeStep = 0.01f;
-	m_gravity = { 0,0 };
-}
-
-
-PhysicsScene::~PhysicsScene()
-{
-	for (int i = 0; i < m_actors.size(); ++i)
-	{
-		delete m_actors[i];
-	}
-}
-
-void PhysicsScene::AddActor(PhysicsObject* actor)
-{
-	m_actors.push_back(actor);
-}
-
-bool PhysicsScene::RemoveActor(PhysicsObject* actor)
-{
-	for (int i = 0; i < m_actors.size(); ++i)
-	{
-		if (actor == m_actors[i])
-		{
-			m_actors.erase(m_actors.begin() + i);
-			return true;
-		}
-	}
-
-	return false;
-}
-
-void PhysicsScene::Update(float dt)
-{
-	debugScene();
-
-	static float accumulatedTime = 0.0f;
-	accumulatedTime += dt;
-
-	while (accumulatedTime >= m_timeStep)
-	{
-		time += m_timeStep;
-		for each (PhysicsObject* actor in m_actors)
-		{
-			actor->fixedUpdate(m_gravity, m_timeStep);
-		}
-
-		accumulatedTime -= m_timeStep;
-
-
-		// check for collisions (ideally you'd want to have some sort of
-		// scene management in place)
-
-		checkForCollision();
-	}
-}
-
-void PhysicsScene::UpdateGizmos()
-{
-	for each (PhysicsObject* actor in m_actors)
-	{
-		actor->makeGizmo();
-	}
-}
-
-void PhysicsScene::checkForCollision()
-{
-	int actorCount = (int)m_actors.size();
-
-	for (int outer = 0; outer < actorCount - 1; ++outer)
-	{
-		for (int inner = outer + 1; inner < actorCount; inner++)
-		{
-			PhysicsObject* object1 = m_actors[outer];
-			PhysicsObject* object2 = m_actors[inner];
-			int shapeID1 = (int)object1->getShapeID();
-			int shapeID2 = (int)object2->getShapeID();
-
-			auto collisionFuncPtr = collisionFuncs[shapeID1][shapeID2];
-			if (collisionFuncPtr)
-			{
-				CollisionInfo info = collisionFuncPtr(object1, object2);
-				if (info.bCollision)
-				{
-					if (shapeID1 == (int)ShapeID::Plane)
-					{
-						Restitution(info.fPenetration, info.collNormal, (RigidBody*)object2);
-						((Plane*)object1)->resolveCollision((RigidBody*)object2, info.collNormal);
-
-						// DEBUG
-						((RigidBody*)object2)->InvertIsFilled();
-					}
-					else if (shapeID2 == (int)ShapeID::Plane)
-					{
-						Restitution(info.fPenetration, info.collNormal, (RigidBody*)object1);
-						((Plane*)object2)->resolveCollision((RigidBody*)object2, info.collNormal);
-
-						// DEBUG
-						((RigidBody*)object1)->InvertIsFilled();
-					}
-					else
-					{
-						Restitution(info.fPenetration, info.collNormal, (RigidBody*)object1, (RigidBody*)object2);
-						((RigidBody*)object1)->resolveCollision((RigidBody*)object2, info.collNormal);
-
-						// DEBUG
-						((RigidBody*)object1)->InvertIsFilled();
-						((RigidBody*)object2)->InvertIsFilled();
-					}
-					bool debug;
-					if (info.collNormal.x != info.collNormal.x)
-						debug = true;
-				}
-			}
-		}
-	}
-}
-
-CollisionInfo PhysicsScene::plane2Plane(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-	return result;
-}
-
-CollisionInfo PhysicsScene::plane2Sphere(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Plane && obj2->getShapeID() == ShapeID::Sphere)
-	{
-		Plane* plane1 = (Plane*)obj1;
-		Sphere* sphere2 = (Sphere*)obj2;
-
-		vec2 collisionNormal = plane1->getNormal();
-		float sphereToPlane = dot(sphere2->getPosition(), plane1->getNormal()) - plane1->getDistance();
-
-		if (sphereToPlane < 0)
-		{
-			collisionNormal *= -1;
-			sphereToPlane *= -1;
-		}
-
-		float intersection = sphere2->getRadius() - sphereToPlane;
-		if (intersection > 0)
-		{
-			result.collNormal = collisionNormal;
-			result.bCollision = true;
-			result.fPenetration = intersection;
-
-			return result;
-		}
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::plane2Box(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Plane && obj2->getShapeID() == ShapeID::Box)
-	{
-		Plane* plane1 = (Plane*)obj1;
-		Box* box2 = (Box*)obj2;
-
-		vec2 collNorm = plane1->getNormal();
-
-		vec2 boxPos = box2->getPosition();
-		vec2 boxExtent = box2->getExtents();
-
-		float r = (boxExtent[0] * abs(collNorm[0])) + (boxExtent[1] * abs(collNorm[1]));
-		float s = dot(collNorm, boxPos) - plane1->getDistance();
-
-		float pen = r - abs(s);
-
-		result.bCollision = pen >= 0;
-		if (result.bCollision)
-		{
-			result.fPenetration = pen;
-			result.collNormal = -collNorm;
-		}
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::plane2Poly(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Plane* plane1 = (Plane*)obj1;
-	Poly* poly2 = (Poly*)obj2;
-	CollisionInfo broad = plane2Sphere(plane1, poly2->GetBroadColl());
-	if (!broad.bCollision)
-		return broad;
-
-	// Perform SAT check
-	CollisionInfo sat;
-	sat.collNormal = plane1->getNormal();
-
-	float polyMax, polyMin;
-	poly2->Project(sat.collNormal, polyMin, polyMax);
-
-	float planeDistance = plane1->getDistance();
-	sat.bCollision = ProjectionOverlap(planeDistance, planeDistance, polyMin, polyMax, sat.fPenetration);
-
-	sat.fPenetration -= (polyMax - polyMin);
-
-	return sat;
-}
-
-CollisionInfo PhysicsScene::plane2Stitched(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Plane* plane1 = (Plane*)obj1;
-	Stitched* stitched1 = (Stitched*)obj2;
-
-	vector<CollisionInfo> allCollInfo;
-	CollisionInfo result;
-	result.collNormal = { 0,0 };
-	int count = stitched1->GetPolyCount();
-
-	for (int i = 0; i < count; ++i)
-	{
-		auto poly = stitched1->GetPoly(i);
-		allCollInfo.push_back(plane2Poly(plane1, poly));
-		result.bCollision |= allCollInfo[i].bCollision;
-	}
-
-	if (result.bCollision)
-	{
-		CollisionInfo backup = allCollInfo[0];
-		
-		int collCount = 0;
-		for (int i = 0; i < count; ++i)
-		{
-			if (allCollInfo[i].bCollision)
-			{
-				++collCount;
-
-				float fPen = allCollInfo[i].fPenetration;
-
-				if (fPen <= 0)
-					fPen = FLT_EPSILON;
-
-				result.collNormal += (allCollInfo[i].collNormal * fPen);
-				
-				if (allCollInfo[i].fPenetration > backup.fPenetration)
-				{
-					backup = allCollInfo[i];
-				}
-			}
-		}
-		result.collNormal /= collCount;
-
-		result.fPenetration = length(result.collNormal);
-		if (result.fPenetration >= 0)
-			result.collNormal = normalize(result.collNormal);
-		else
-			result = backup;		
-	}
-
-	return result;
-}
-
-CollisionInfo PhysicsScene::sphere2Plane(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Sphere && obj2->getShapeID() == ShapeID::Plane)
-	{
-		Sphere* sphere1 = (Sphere*)obj1;
-		Plane* plane2 = (Plane*)obj2;
-
-		return plane2Sphere(plane2, sphere1);
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::sphere2Sphere(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Sphere && obj2->getShapeID() == ShapeID::Sphere)
-	{
-		Sphere* sphere1 = (Sphere*)obj1;
-		Sphere* sphere2 = (Sphere*)obj2;
-
-		float seperation = glm::distance(sphere1->getPosition(), sphere2->getPosition());
-		float fRadiusSum = sphere1->getRadius() + sphere2->getRadius();
-
-		// IF collision
-		if (seperation < fRadiusSum)
-		{
-			float pen = seperation - fRadiusSum;
-
-			result.fPenetration = pen;
-			result.collNormal = normalize(sphere1->getPosition() - sphere2->getPosition());
-			result.bCollision = true;
-
-			return result;
-		}
-	}
-
-	return result;
-}
-
-CollisionInfo PhysicsScene::sphere2Box(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Sphere && obj2->getShapeID() == ShapeID::Box)
-	{
-		Sphere* sphere1 = (Sphere*)obj1;
-		Box* box2 = (Box*)obj2;
-
-		vec2 boxMax = box2->getPosition() + box2->getExtents();
-		vec2 boxMin = box2->getPosition() - box2->getExtents();
-
-		vec2 spherePos = sphere1->getPosition();
-		vec2 v2Clamp = clamp(spherePos, boxMin, boxMax);
-
-		v2Clamp -= spherePos;		
-		if (length(v2Clamp) <= sphere1->getRadius())
-		{
-			float pen = length(v2Clamp) - sphere1->getRadius();
-			
-			if (v2Clamp == vec2(0, 0))
-				result.collNormal = normalize(spherePos - box2->getPosition());
-			else
-				result.collNormal = normalize(v2Clamp);
-
-			result.bCollision = true;
-			result.fPenetration = pen;
-			
-			return result;
-		}
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::sphere2Poly(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Sphere* sphere1 = (Sphere*)obj1;
-	Poly* poly2 = (Poly*)obj2;
-	CollisionInfo broad = sphere2Sphere(sphere1, poly2->GetBroadColl());
-	if (!broad.bCollision)
-		return broad;
-
-	// Perform SAT check
-	CollisionInfo sat;
-	sat.fPenetration = FLT_MAX;
-
-	float sphereDot, sphereMax, sphereMin;
-	float polyMax, polyMin;
-	float overlap;
-
-	for (int i = 0; i < poly2->GetSNormCount(); ++i)
-	{
-		if (poly2->GetSNormParallel(i))
-			continue;
-
-		vec2 norm = poly2->GetRotatedSNorm(i);
-
-		sphereDot = dot(norm, sphere1->getPosition());
-		sphereMax = sphereDot + sphere1->getRadius();
-		sphereMin = sphereDot - sphere1->getRadius();
-
-		poly2->Project(norm, polyMin, polyMax);
-
-		sat.bCollision = ProjectionOverlap(sphereMin, sphereMax, polyMin, polyMax, overlap);
-
-		//No collision EARLY EXIT
-		if (!(sat.bCollision))
-			return sat;
-
-		overlap -= (polyMax - polyMin);
-		overlap -= (sphereMax - sphereMin);
-
-		overlap = abs(overlap);
-
-		if (sat.fPenetration > overlap)
-		{
-			sat.fPenetration = overlap;
-			sat.collNormal = norm;
-		}
-	}
-
-	return sat;
-}
-
-CollisionInfo PhysicsScene::sphere2Stitched(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Sphere* sphere1 = (Sphere*)obj1;
-	Stitched* stitched1 = (Stitched*)obj2;
-
-	vector<CollisionInfo> allCollInfo;
-	CollisionInfo result;
-	result.collNormal = { 0,0 };
-	int count = stitched1->GetPolyCount();
-
-	for (int i = 0; i < count; ++i)
-	{
-		auto poly = stitched1->GetPoly(i);
-		allCollInfo.push_back(sphere2Poly(sphere1, poly));
-		result.bCollision += allCollInfo[i].bCollision;
-	}
-
-	if (result.bCollision)
-	{
-		CollisionInfo backup;
-
-		int collCount = 0;
-		for (int i = 0; i < count; ++i)
-		{
-			if (allCollInfo[i].bCollision)
-			{
-				++collCount;
-				float fPen = allCollInfo[i].fPenetration;
-
-				if (fPen <= 0)
-					fPen = FLT_EPSILON;
-
-				result.collNormal += (allCollInfo[i].collNormal * fPen);
-
-				if (allCollInfo[i].fPenetration > backup.fPenetration)
-				{
-					backup = allCollInfo[i];
-				}
-			}
-		}
-		result.collNormal /= collCount;
-
-		result.fPenetration = length(result.collNormal);
-		if (result.fPenetration > FLT_EPSILON)
-			result.collNormal = normalize(result.collNormal);
-		else
-			result = backup;
-
-		//result = backup;
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::box2Plane(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Box && obj2->getShapeID() == ShapeID::Plane)
-	{
-		Box* box1 = (Box*)obj1;
-		Plane* plane2 = (Plane*)obj2;
-
-		return plane2Box(plane2, box1);
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::box2Sphere(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Box && obj2->getShapeID() == ShapeID::Sphere)
-	{
-		Box* box1 = (Box*)obj1;
-		Sphere* sphere2 = (Sphere*)obj2;
-
-		return sphere2Box(sphere2, box1);
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::box2Box(PhysicsObject* obj1, PhysicsObject* obj2)
-{
-	CollisionInfo result;
-	result.bCollision = false;
-
-	if (obj1->getShapeID() == ShapeID::Box && obj2->getShapeID() == ShapeID::Box)
-	{
-		Box* box1 = (Box*)obj1;
-		Box* box2 = (Box*)obj2;
-
-		vec2 box1Pos = box1->getPosition();
-		vec2 box2Pos = box2->getPosition();
-
-		vec2 box1Min = box1Pos - box1->getExtents();
-		vec2 box1Max = box1Pos + box1->getExtents();
-		vec2 box2Min = box2Pos - box2->getExtents();
-		vec2 box2Max = box2Pos + box2->getExtents();
-
-		static const vec2 faces[4] =
-		{
-			vec2(-1,  0), // 'left' face normal (-x direction)
-			vec2(1,  0), // 'right' face normal (+x direction)
-			vec2(0, -1), // 'bottom' face normal (-y direction)
-			vec2(0,  1), // 'top' face normal (+y direction)
-		};
-
-		float distances[4] =
-		{
-			(box2Max.x - box1Min.x), // distance of box 'b' to face on 'left' side of 'a'.
-			(box1Max.x - box2Min.x), // distance of box 'b' to face on 'right' side of 'a'.
-			(box2Max.y - box1Min.y), // distance of box 'b' to face on 'bottom' side of 'a'.
-			(box1Max.y - box2Min.y), // distance of box 'b' to face on 'top' side of 'a'.
-		};
-
-		vec2 collisionNormal;
-		float pen;
-
-		for (int i = 0; i < 4; i++)
-		{
-			// box does not intersect face. So boxes don't intersect at all.
-			if (distances[i] < 0.0f || distances[i] != distances[i])
-				return result;
-
-			// face of least intersection depth. That's our candidate.
-			if ((i == 0) || (distances[i] < pen))
-			{
-				collisionNormal = faces[i];
-				pen = distances[i];
-			}
-		}
-
-		result.collNormal = collisionNormal;
-		result.bCollision = true;
-		result.fPenetration = pen;
-		
-		return result;
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::box2Poly(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Box* box1 = (Box*)obj1;
-	Poly* poly2 = (Poly*)obj2;
-	CollisionInfo broad = box2Sphere(box1, poly2->GetBroadColl());
-	if (!broad.bCollision)
-		return broad;
-
-	// Perform SAT check
-	CollisionInfo sat;
-	sat.fPenetration = FLT_MAX;
-
-	float boxMax, boxMin;
-	float polyMax, polyMin;
-	float overlap;
-
-	vec2 boxPos = box1->getPosition();
-	vec2 boxExtent = box1->getExtents();
-
-	vec2 boxVerts[4] =
-	{
-		boxPos + boxExtent,
-		boxPos + vec2(boxExtent.x, -boxExtent.y),
-		boxPos + -boxExtent,
-		boxPos + vec2(-boxExtent.x, boxExtent.y)
-	};
-
-	static const vec2 boxNorms[2] = { vec2(0,1), vec2(1,0) };
-	for (int i = 1; i < 2; ++i)
-	{
-		vec2 norm = boxNorms[i];
-
-		boxMin = dot(norm, boxVerts[2]);
-		boxMax = boxMin;
-		for (int i = 0; i < 4; ++i)
-		{
-			float temp = dot(norm, boxVerts[i]);
-			if (temp < boxMin)
-			{
-				boxMin = temp;
-			}
-			else if (temp > boxMax)
-			{
-				boxMax = temp;
-			}
-		}
-
-		poly2->Project(norm, polyMin, polyMax);
-
-		sat.bCollision = ProjectionOverlap(boxMin, boxMax, polyMin, polyMax, overlap);
-
-		//No collision EARLY EXIT
-		if (!(sat.bCollision))
-			return sat;
-
-		overlap -= (polyMax - polyMin);
-		overlap -= (boxMax - boxMin);
-
-		overlap = abs(overlap);
-
-		if (sat.fPenetration > overlap)
-		{
-			sat.fPenetration = overlap;
-			sat.collNormal = norm;
-		}
-	}
-
-	for (int i = 0; i < poly2->GetSNormCount(); ++i)
-	{
-		if (poly2->GetSNormParallel(i))
-			continue;
-
-		vec2 norm = poly2->GetRotatedSNorm(i);
-
-		boxMin = dot(norm, boxVerts[2]);
-		boxMax = boxMin;
-		for (int i = 0; i < 4; ++i)
-		{
-			float temp = dot(norm, boxVerts[i]);
-			if (temp < boxMin)
-			{
-				boxMin = temp;
-			}
-			else if (temp > boxMax)
-			{
-				boxMax = temp;
-			}
-		}
-
-		poly2->Project(norm, polyMin, polyMax);
-
-		sat.bCollision = ProjectionOverlap(boxMin, boxMax, polyMin, polyMax, overlap);
-
-		//No collision EARLY EXIT
-		if (!(sat.bCollision))
-			return sat;
-
-		overlap -= (polyMax - polyMin);
-		overlap -= (boxMax - boxMin);
-
-		overlap = abs(overlap);
-
-		if (sat.fPenetration > overlap)
-		{
-			sat.fPenetration = overlap;
-			sat.collNormal = norm;
-		}
-	}	
-
-	return sat;
-}
-
-CollisionInfo PhysicsScene::box2Stitched(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Box* box1 = (Box*)obj1;
-	Stitched* stitched1 = (Stitched*)obj2;
-
-	vector<CollisionInfo> allCollInfo;
-	CollisionInfo result;
-	result.collNormal = { 0,0 };
-	int count = stitched1->GetPolyCount();
-
-	for (int i = 0; i < count; ++i)
-	{
-		auto poly = stitched1->GetPoly(i);
-		allCollInfo.push_back(box2Poly(box1, poly));
-		result.bCollision += allCollInfo[i].bCollision;
-	}
-
-	if (result.bCollision)
-	{
-		CollisionInfo backup;
-
-		int collCount = 0;
-		for (int i = 0; i < count; ++i)
-		{
-			if (allCollInfo[i].bCollision)
-			{
-				++collCount;
-				float fPen = allCollInfo[i].fPenetration;
-
-				if (fPen <= 0)
-					fPen = FLT_EPSILON;
-
-				result.collNormal += (allCollInfo[i].collNormal * fPen);
-
-				if (allCollInfo[i].fPenetration > backup.fPenetration)
-				{
-					backup = allCollInfo[i];
-				}
-			}
-		}
-		result.collNormal /= collCount;
-
-		result.fPenetration = length(result.collNormal);
-		if (result.fPenetration > FLT_EPSILON)
-			result.collNormal = normalize(result.collNormal);
-		else
-			result = backup;
-
-		//result = backup;
-	}
-	return result;
-}
-
-CollisionInfo PhysicsScene::poly2Plane(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return plane2Poly(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::poly2Sphere(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return sphere2Poly(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::poly2Box(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return box2Poly(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::poly2Poly(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Poly* poly1 = (Poly*)obj1;
-	Poly* poly2 = (Poly*)obj2;
-	CollisionInfo broad = sphere2Sphere(poly1->GetBroadColl(), poly2->GetBroadColl());
-	if (!broad.bCollision)
-		return broad;
-
-	// Perform SAT check
-	CollisionInfo sat;
-	sat.fPenetration = FLT_MAX;
-	
-	float poly1Max, poly1Min;
-	float poly2Max, poly2Min;
-	float overlap;
-	
-	for (int i = 0; i < poly1->GetSNormCount(); ++i)
-	{
-		if (poly1->GetSNormParallel(i))
-			continue;
-
-		vec2 norm = poly1->GetRotatedSNorm(i);		
-	
-		poly1->Project(norm, poly1Min, poly1Max);
-		poly2->Project(norm, poly2Min, poly2Max);
-	
-		sat.bCollision = ProjectionOverlap(poly1Min, poly1Max, poly2Min, poly2Max, overlap);
-	
-		//No collision EARLY EXIT
-		if (!(sat.bCollision))
-			return sat;
-	
-		overlap -= (poly1Max - poly1Min);
-		overlap -= (poly2Max - poly2Min);
-	
-		overlap = abs(overlap);
-	
-		if (sat.fPenetration > overlap)
-		{
-			sat.fPenetration = overlap;
-			sat.collNormal = norm;
-		}
-	}
-	
-	for (int i = 0; i < poly2->GetSNormCount(); ++i)
-	{
-		if (poly2->GetSNormParallel(i))
-			continue;
-
-		vec2 norm = poly2->GetRotatedSNorm(i);
-	
-		poly1->Project(norm, poly1Min, poly1Max);
-		poly2->Project(norm, poly2Min, poly2Max);
-	
-		sat.bCollision = ProjectionOverlap(poly1Min, poly1Max, poly2Min, poly2Max, overlap);
-	
-		//No collision EARLY EXIT
-		if (!(sat.bCollision))
-			return sat;
-	
-		overlap -= (poly1Max - poly1Min);
-		overlap -= (poly2Max - poly2Min);
-	
-		overlap = abs(overlap);
-	
-		if (sat.fPenetration > overlap)
-		{
-			sat.fPenetration = overlap;
-			sat.collNormal = norm;
-		}
-	}
-
-	return sat;
-}
-
-CollisionInfo PhysicsScene::poly2Stitched(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Poly* poly1 = (Poly*)obj1;
-	Stitched* stitched1 = (Stitched*)obj2;
-
-	vector<CollisionInfo> allCollInfo;
-	CollisionInfo result;
-	result.collNormal = { 0,0 };
-	int count = stitched1->GetPolyCount();
-
-	for (int i = 0; i < count; ++i)
-	{
-		auto poly = stitched1->GetPoly(i);
-		allCollInfo.push_back(poly2Poly(poly1, poly));
-		result.bCollision += allCollInfo[i].bCollision;
-	}
-
-	if (result.bCollision)
-	{
-		CollisionInfo backup;
-
-		int collCount = 0;
-		for (int i = 0; i < count; ++i)
-		{
-			if (allCollInfo[i].bCollision)
-			{
-				++collCount;
-				float fPen = allCollInfo[i].fPenetration;
-
-				if (fPen <= 0)
-					fPen = FLT_EPSILON;
-
-				result.collNormal += (allCollInfo[i].collNormal * fPen);
-
-				if (allCollInfo[i].fPenetration > backup.fPenetration)
-				{
-					backup = allCollInfo[i];
-				}
-			}
-		}
-		result.collNormal /= collCount;
-
-		result.fPenetration = length(result.collNormal);
-		if (result.fPenetration > FLT_EPSILON)
-			result.collNormal = normalize(result.collNormal);
-		else
-			result = backup;
-	}
-
-	return result;
-}
-
-CollisionInfo PhysicsScene::stitched2Plane(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return plane2Stitched(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::stitched2Sphere(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return sphere2Stitched(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::stitched2Box(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return box2Stitched(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::stitched2Poly(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	return poly2Stitched(obj2, obj1);
-}
-
-CollisionInfo PhysicsScene::stitched2Stitched(PhysicsObject * obj1, PhysicsObject * obj2)
-{
-	Stitched* stitched1 = (Stitched*)obj1;
-	Stitched* stitched2 = (Stitched*)obj2;
-
-	vector<CollisionInfo> allCollInfo;
-	CollisionInfo result;
-	result.collNormal = { 0,0 };
-	int count1 = stitched1->GetPolyCount();
-	int count2 = stitched2->GetPolyCount();
-
-	for (int i = 0; i < count1; ++i)
-	{
-		auto poly1 = stitched1->GetPoly(i);
-
-		allCollInfo.push_back(poly2Stitched(poly1, stitched2));
-		result.bCollision += allCollInfo[i].bCollision;
-
-		//for (int j = 0; j < count2; ++j)
-		//{
-		//	auto poly2 = stitched2->GetPoly(j);
-		//	allCollInfo.push_back(poly2Poly(poly1, poly2));
-		//	result.bCollision += allCollInfo[i].bCollision;
-		//}
-	}
-
-	if (result.bCollision)
-	{
-		CollisionInfo backup;
-
-		int collCount = 0;
-		for (int i = 0; i < allCollInfo.size(); ++i)
-		{
-			if (allCollInfo[i].bCollision)
-			{
-				++collCount;
-				float fPen = allCollInfo[i].fPenetration;
-
-				if (fPen <= 0)
-					fPen = FLT_EPSILON;
-
-				result.collNormal += (allCollInfo[i].collNormal * fPen);
-
-				if (allCollInfo[i].fPenetration > backup.fPenetration)
-				{
-					backup = allCollInfo[i];
-				}
-			}
-		}
-		result.collNormal /= collCount;
-
-		result.fPenetration = length(result.collNormal);
-		if (result.fPenetration > FLT_EPSILON)
-			result.collNormal = normalize(result.collNormal);
-		else
-			result = backup;
-	}
-
-	return result;
-}
-
-void PhysicsScene::Restitution(float overlap, glm::vec2 const& collNormal, RigidBody * rb1, RigidBody * rb2)
-{
-	if (overlap <= 0.01f)
-		return;
-
-	float time = 0;
-	vec2 rb1Pos = rb1->getPosition();
-	vec2 rb1Vel = rb1->getVelocity();
-	float rb1Rot = rb1->getRotation();
-
-	vec2 relVel = rb1Vel;
-
-	vec2 rb1Offset = {0,0};
-	float ratio = 1;
-	if (rb2)
-	{
-		vec2 rb2Pos = rb2->getPosition();
-		vec2 rb2Vel = rb2->getVelocity();
-		float rb2Rot = rb2->getRotation();
-
-		float rb1InvMass = 1 / rb1->getMass();
-		float rb2InvMass = 1 / rb2->getMass();
-
-		float rb1Mom = rb1InvMass * length(rb1Vel);
-		float rb2Mom = rb2InvMass * length(rb2Vel);
-
-		ratio = rb1Mom / (rb1Mom + rb2Mom);
-
-		relVel -= rb2Vel;
-
-		//float relSpeed = length(relVel);
-		float relSpeed = abs(dot(relVel, collNormal));
-
-		vec2 rb2Offset;
-		if (relSpeed > FLT_EPSILON)
-		{
-			float time = overlap / relSpeed;
-			rb1Offset = rb1Vel * time * ratio;
-			rb2Offset = rb2Vel * time * (1 - ratio);
-		}
-		else
-		{
-			rb1Offset = collNormal * overlap * ratio;
-			rb2Offset = -collNormal * overlap * (1 - ratio);
-		}
-
-		rb2->setPosition(rb2Pos - rb2Offset);
-	}
-	else
-	{
-		//float relSpeed = length(relVel);
-		float relSpeed = abs(dot(relVel, collNormal));
-
-		if (relSpeed > FLT_EPSILON)
-		{
-			float time = overlap / relSpeed;
-			rb1Offset = rb1Vel * time * ratio;
-		}
-		else
-		{
-			rb1Offset = -collNormal * overlap;
-		}
-	}
-
-	rb1->setPosition(rb1Pos - rb1Offset);
-	return;
-}
-
-void PhysicsScene::debugScene()
-{
-	if (debugCount == 0)
-	{
-		system("CLS");
-		int count = 0;
-		for (auto pActor : m_actors) {
-			std::cout << count << " : ";
-			pActor->debug();
-			printf("\n");
-			count++;
-		}
-	}
-
-	debugCount++;
-	if (debugCount > DEBUG_FREQ)
-		debugCount = 0;
-}
-
-bool PhysicsScene::ProjectionOverlap(float const & min1, float const & max1, float const & min2, float const & max2, float & overlap)
-{
-	if (max1 <= min2)	return false;
-	if (max2 <= min1)	return false;
-
-	// Overlap
-	float fMin = min(min1, min2);
-	float fMax = max(max1, max2);
-
-	overlap = fMax - fMin;
-	return true;
-}
+#include "PhysicsScene.h"
+#include "PhysicsObject.h"
+#include <list>
+#include "RigidBody.h"
+#include <iostream>
+#include "Plane.h"
+#include "Sphere.h"
+#include "Box.h"
+#include "Poly.h"
+#include "Stitched.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include "AllocGuard.h"
+
+#define DEBUG_FREQ 5
+
+static bool UsesSATCache(int shapeID1, int shapeID2)
+{
+	bool bPoly1 = shapeID1 == (int)ShapeID::Poly;
+	bool bPoly2 = shapeID2 == (int)ShapeID::Poly;
+
+	return (bPoly1 && (bPoly2 || shapeID2 == (int)ShapeID::Box)) ||
+		(bPoly2 && shapeID1 == (int)ShapeID::Box);
+}
+
+/***
+ * @brief Blends the contacts of a Stitched body's sub-polys into one, weighting
+ *			each normal by its penetration. Contacts are folded in as they are
+ *			found so a test needs no storage per sub-poly.
+ */
+struct ContactBlend
+{
+	vec2 normalSum = { 0,0 };
+	int collCount = 0;
+	// fallback for when the weighted normals cancel out
+	CollisionInfo deepest;
+
+	void Add(CollisionInfo const& info)
+	{
+		if (!info.bCollision)
+			return;
+
+		if (collCount == 0 || info.fPenetration > deepest.fPenetration)
+			deepest = info;
+		++collCount;
+
+		float fPen = info.fPenetration;
+		if (fPen <= 0)
+			fPen = FLT_EPSILON;
+
+		normalSum += info.collNormal * fPen;
+	}
+
+	CollisionInfo Result() const
+	{
+		CollisionInfo result;
+		result.collNormal = { 0,0 };
+		if (collCount == 0)
+			return result;
+
+		result.bCollision = true;
+		result.collNormal = normalSum / (float)collCount;
+		result.fPenetration = length(result.collNormal);
+		if (result.fPenetration > FLT_EPSILON)
+			result.collNormal = normalize(result.collNormal);
+		else
+			result = deepest;
+
+		return result;
+	}
+};
+
+PhysicsScene::PhysicsScene()
+{
+	m_timeStep = 0.01f;
+	m_gravity = { 0,0 };
+
+	m_pJobs = &aie::JobSystem::getDefault();
+	BuildStepGraph();
+
+	m_Commands.reserve(m_CommandQueue.GetCapacity());
+}
+
+
+PhysicsScene::~PhysicsScene()
+{
+	if (m_StepThread.joinable())
+	{
+		EndStep();
+		{
+			std::lock_guard<std::mutex> lock(m_StepMutex);
+			m_bStopWorker = true;
+		}
+		m_StepCondition.notify_all();
+		m_StepThread.join();
+	}
+
+	for (int i = 0; i < m_actors.size(); ++i)
+	{
+		delete m_actors[i];
+	}
+	DeleteRemovedActors();
+}
+
+void PhysicsScene::AddActor(PhysicsObject* actor)
+{
+	m_bQueryTreeStale = true;
+
+	actor->m_uID = m_nextActorID++;
+
+	if (actor->m_uID >= m_ActorIndexByID.size())
+		m_ActorIndexByID.resize(actor->m_uID + 1, -1);
+	m_ActorIndexByID[actor->m_uID] = (int)m_actors.size();
+
+	m_actors.push_back(actor);
+	m_shapes.push_back(MakeShapeRef(actor));
+
+	// Until it has been stepped a body draws where it was added
+	BodyState state;
+	if (actor->getShapeID() != ShapeID::Plane)
+		state = ((RigidBody*)actor)->GetState();
+	m_prevStates.push_back(state);
+	m_currStates.push_back(state);
+
+	// Grow the per step storage here rather than inside Update
+	if ((int)m_actors.size() > m_reservedActors)
+		Reserve(m_reservedActors * 2 > (int)m_actors.size() ? m_reservedActors * 2 : (int)m_actors.size());
+}
+
+PhysicsObject* PhysicsScene::FindActor(uint32_t uActorID) const
+{
+	if (uActorID >= m_ActorIndexByID.size() || m_ActorIndexByID[uActorID] < 0)
+		return nullptr;
+
+	return m_actors[m_ActorIndexByID[uActorID]];
+}
+
+bool PhysicsScene::QueueAdd(PhysicsObject* actor, uint32_t uOrderKey)
+{
+	return m_CommandQueue.Push({ SceneCommand::Type::Add, uOrderKey, 0, actor, { 0,0 }, 0 });
+}
+
+bool PhysicsScene::QueueRemove(uint32_t uActorID, uint32_t uOrderKey)
+{
+	return m_CommandQueue.Push({ SceneCommand::Type::Remove, uOrderKey, uActorID, nullptr, { 0,0 }, 0 });
+}
+
+bool PhysicsScene::QueueImpulse(uint32_t uActorID, glm::vec2 const& impulse, uint32_t uOrderKey)
+{
+	return m_CommandQueue.Push({ SceneCommand::Type::Impulse, uOrderKey, uActorID, nullptr, impulse, 0 });
+}
+
+bool PhysicsScene::QueueTeleport(uint32_t uActorID, glm::vec2 const& position, float rotation, uint32_t uOrderKey)
+{
+	return m_CommandQueue.Push({ SceneCommand::Type::Teleport, uOrderKey, uActorID, nullptr, position, rotation });
+}
+
+void PhysicsScene::ApplyCommands()
+{
+	m_Commands.clear();
+
+	SceneCommand command;
+	while (m_CommandQueue.Pop(command))
+	{
+		command.uSequence = (uint32_t)m_Commands.size();
+		m_Commands.push_back(command);
+	}
+
+	if (m_Commands.empty())
+		return;
+
+	// Arrival order depends on thread timing, so sort on the commands alone.
+	// Adds have no ID yet, one key's adds all come from one thread, and the
+	// queue keeps each thread's commands in the order it pushed them.
+	std::sort(m_Commands.begin(), m_Commands.end(), [](SceneCommand const& lhs, SceneCommand const& rhs)
+	{
+		if (lhs.uOrderKey != rhs.uOrderKey)
+			return lhs.uOrderKey < rhs.uOrderKey;
+		bool bLhsAdd = lhs.type == SceneCommand::Type::Add;
+		bool bRhsAdd = rhs.type == SceneCommand::Type::Add;
+		if (bLhsAdd || bRhsAdd)
+			return bLhsAdd && bRhsAdd ? lhs.uSequence < rhs.uSequence : bLhsAdd;
+		if (lhs.uActorID != rhs.uActorID)
+			return lhs.uActorID < rhs.uActorID;
+		if (lhs.type != rhs.type)
+			return lhs.type < rhs.type;
+		if (lhs.vec.x != rhs.vec.x)
+			return lhs.vec.x < rhs.vec.x;
+		if (lhs.vec.y != rhs.vec.y)
+			return lhs.vec.y < rhs.vec.y;
+		return lhs.fRotation < rhs.fRotation;
+	});
+
+	for (int i = 0; i < (int)m_Commands.size(); ++i)
+	{
+		SceneCommand const& command = m_Commands[i];
+		if (command.type == SceneCommand::Type::Add)
+		{
+			AddActor(command.pActor);
+			continue;
+		}
+
+		PhysicsObject* actor = FindActor(command.uActorID);
+		if (actor == nullptr)
+			continue;
+
+		if (command.type == SceneCommand::Type::Remove)
+		{
+			RemoveActor(actor);
+
+			// The render snapshot may still be drawing it on the main thread
+			if (m_bAsync)
+				m_RemovedActors.push_back(actor);
+			else
+				delete actor;
+			continue;
+		}
+
+		// Planes do not move
+		if (actor->getShapeID() == ShapeID::Plane)
+			continue;
+
+		RigidBody* pBody = (RigidBody*)actor;
+		if (command.type == SceneCommand::Type::Impulse)
+		{
+			pBody->applyForce(command.vec);
+		}
+		else
+		{
+			pBody->SetPose(command.vec, command.fRotation);
+
+			// A teleport should not be blended from where the body was
+			int index = m_ActorIndexByID[command.uActorID];
+			m_prevStates[index] = m_currStates[index] = pBody->GetState();
+		}
+	}
+}
+
+void PhysicsScene::Reserve(int actorCount, int pairCount)
+{
+	if (pairCount < 0)
+		pairCount = actorCount * PAIRS_PER_ACTOR;
+
+	m_actors.reserve(actorCount);
+	m_shapes.reserve(actorCount);
+	m_ActorIndexByID.reserve(actorCount + 1);
+	m_prevStates.reserve(actorCount);
+	m_currStates.reserve(actorCount);
+	m_renderActors.reserve(actorCount);
+	m_RemovedActors.reserve(actorCount);
+	m_renderPrevStates.reserve(actorCount);
+	m_renderCurrStates.reserve(actorCount);
+	m_Pairs.reserve(pairCount);
+	m_IslandParent.reserve(actorCount);
+	m_IslandOfRoot.reserve(actorCount);
+	m_PairIsland.reserve(pairCount);
+	m_IslandStart.reserve(pairCount + 1);
+	m_IslandPairs.reserve(pairCount);
+	m_PairCaches.reserve(pairCount);
+	m_PairContacts.reserve(pairCount);
+	m_SensorPairs.reserve(pairCount);
+	m_PairResolutions.reserve(pairCount);
+	m_BodyPairStart.reserve(actorCount + 1);
+	m_BodyPairs.reserve(pairCount * 2);
+	m_Contacts.reserve(pairCount);
+	m_NextContacts.reserve(pairCount);
+	m_ContactEvents.reserve(pairCount * 2);
+	m_Broadphase.Reserve(actorCount);
+	m_SATCache.Reserve(pairCount);
+
+	if (actorCount > m_reservedActors)
+		m_reservedActors = actorCount;
+}
+
+bool PhysicsScene::RemoveActor(PhysicsObject* actor)
+{
+	m_bQueryTreeStale = true;
+
+	for (int i = 0; i < m_actors.size(); ++i)
+	{
+		if (actor == m_actors[i])
+		{
+			m_actors.erase(m_actors.begin() + i);
+			m_shapes.erase(m_shapes.begin() + i);
+			m_prevStates.erase(m_prevStates.begin() + i);
+			m_currStates.erase(m_currStates.begin() + i);
+
+			m_ActorIndexByID[actor->m_uID] = -1;
+			for (int j = i; j < m_actors.size(); ++j)
+				m_ActorIndexByID[m_actors[j]->m_uID] = j;
+
+			// It may be added again, here or to another scene
+			actor->m_uID = 0;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PhysicsScene::Update(float dt)
+{
+	debugScene();
+
+	m_accumulatedTime += dt;
+	m_ContactEvents.clear();
+
+#ifdef PHYSIK_ALLOC_GUARD
+	bool bGuarded = ++m_guardedUpdates > AllocGuard::WARMUP_UPDATES;
+	if (bGuarded)
+		m_AllocGuard.Arm();
+#endif
+
+	auto startTime = std::chrono::steady_clock::now();
+	int steps = 0;
+
+	while (m_accumulatedTime >= m_timeStep)
+	{
+		// Past either limit the frame stops stepping, or a slow frame owes
+		// more steps to the next one and never catches up
+		if (steps >= m_maxStepsPerUpdate)
+			break;
+
+		// Wall clock time differs between runs, so deterministic mode only
+		// goes by the step count
+		if (m_fStepBudget > 0 && steps > 0 && !m_bDeterministic &&
+			std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count() >= m_fStepBudget)
+			break;
+
+		Step();
+		m_accumulatedTime -= m_timeStep;
+		++steps;
+	}
+
+	m_StepStats.steps = steps;
+	m_StepStats.fStepTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (m_accumulatedTime >= m_timeStep)
+	{
+		++m_StepStats.overBudgetUpdates;
+
+		// Drop keeps only the part step, dilate carries up to an update's
+		// worth of steps and lets the scene fall behind real time
+		float fKeep = fmodf(m_accumulatedTime, m_timeStep);
+		if (m_StepOverflow == StepOverflow::Dilate)
+			fKeep = glm::min(m_accumulatedTime, m_maxStepsPerUpdate * m_timeStep);
+
+		m_StepStats.fDroppedTime += m_accumulatedTime - fKeep;
+		m_accumulatedTime = fKeep;
+	}
+
+	m_StepStats.fDebt = m_accumulatedTime >= m_timeStep ? m_accumulatedTime : 0;
+
+#ifdef PHYSIK_ALLOC_GUARD
+	if (bGuarded)
+		m_AllocGuard.Check("PhysicsScene::Update");
+#endif
+}
+
+void PhysicsScene::Step()
+{
+	ApplyCommands();
+
+	++m_uStepCount;
+	time += m_timeStep;
+	m_SATCache.BeginStep();
+
+	m_StepGraph.Run(*m_pJobs);
+}
+
+void PhysicsScene::ReserveSnapshots(int frameCount)
+{
+	m_Snapshots.resize(frameCount);
+
+	int actorCount = glm::max(m_reservedActors, (int)m_actors.size());
+	for (int i = 0; i < frameCount; ++i)
+	{
+		SceneSnapshot& snapshot = m_Snapshots[i];
+		snapshot.bSaved = false;
+		snapshot.bodies.reserve(actorCount);
+		snapshot.prevStates.reserve(actorCount);
+		snapshot.currStates.reserve(actorCount);
+		m_SATCache.ReserveSnapshot(snapshot.satCache);
+		snapshot.contacts.reserve(m_Contacts.capacity());
+	}
+}
+
+void PhysicsScene::SaveSnapshot()
+{
+	if (m_Snapshots.empty())
+		return;
+
+	SceneSnapshot& snapshot = m_Snapshots[m_uStepCount % m_Snapshots.size()];
+	snapshot.uStep = m_uStepCount;
+	snapshot.bSaved = true;
+	snapshot.fAccumulatedTime = m_accumulatedTime;
+	snapshot.fTime = time;
+	snapshot.uStateHash = m_uStateHash;
+
+	snapshot.bodies.resize(m_actors.size());
+	for (int i = 0; i < (int)m_actors.size(); ++i)
+	{
+		if (m_actors[i]->getShapeID() == ShapeID::Plane)
+			snapshot.bodies[i].uID = m_actors[i]->GetID();
+		else
+			((RigidBody*)m_actors[i])->SaveSnapshot(snapshot.bodies[i]);
+	}
+
+	// BodyState and the cache entries are plain data, these are memcpys
+	snapshot.prevStates = m_prevStates;
+	snapshot.currStates = m_currStates;
+	m_SATCache.Save(snapshot.satCache);
+	snapshot.contacts = m_Contacts;
+}
+
+SceneSnapshot const* PhysicsScene::FindSnapshot(uint32_t uStep) const
+{
+	if (m_Snapshots.empty())
+		return nullptr;
+
+	SceneSnapshot const& snapshot = m_Snapshots[uStep % m_Snapshots.size()];
+	if (!snapshot.bSaved || snapshot.uStep != uStep)
+		return nullptr;
+
+	return &snapshot;
+}
+
+bool PhysicsScene::RestoreSnapshot(uint32_t uStep)
+{
+	SceneSnapshot const* pSnapshot = FindSnapshot(uStep);
+	if (pSnapshot == nullptr || pSnapshot->bodies.size() != m_actors.size())
+		return false;
+
+	for (int i = 0; i < (int)m_actors.size(); ++i)
+	{
+		if (pSnapshot->bodies[i].uID != m_actors[i]->GetID())
+			return false;
+	}
+
+	m_uStepCount = pSnapshot->uStep;
+	m_accumulatedTime = pSnapshot->fAccumulatedTime;
+	time = pSnapshot->fTime;
+	m_uStateHash = pSnapshot->uStateHash;
+
+	for (int i = 0; i < (int)m_actors.size(); ++i)
+	{
+		if (m_actors[i]->getShapeID() != ShapeID::Plane)
+			((RigidBody*)m_actors[i])->LoadSnapshot(pSnapshot->bodies[i]);
+	}
+
+	m_prevStates = pSnapshot->prevStates;
+	m_currStates = pSnapshot->currStates;
+	m_SATCache.Restore(pSnapshot->satCache);
+	m_Contacts = pSnapshot->contacts;
+
+	// The tree still holds the last step's bounds
+	m_Broadphase.Build(m_actors);
+	m_bQueryTreeStale = false;
+
+	return true;
+}
+
+template <class F>
+void PhysicsScene::ForEachQueryCandidate(Bounds const& bounds, F&& func) const
+{
+	if (m_bQueryTreeStale)
+	{
+		for (int i = 0; i < (int)m_actors.size(); ++i)
+		{
+			if (m_actors[i]->getShapeID() == ShapeID::Plane || BoundsOverlap(m_actors[i]->GetBounds(), bounds))
+				func(i);
+		}
+		return;
+	}
+
+	for (int plane : m_Broadphase.GetUnbounded())
+		func(plane);
+
+	m_Broadphase.QueryBounds(bounds, func);
+}
+
+template <class F>
+void PhysicsScene::ForEachRayCandidate(vec2 const& origin, vec2 const& direction, float fMaxDistance, F&& func) const
+{
+	if (m_bQueryTreeStale)
+	{
+		for (int i = 0; i < (int)m_actors.size(); ++i)
+		{
+			if (m_actors[i]->getShapeID() == ShapeID::Plane ||
+				Broadphase::RayHitsBounds(m_actors[i]->GetBounds(), origin, direction, fMaxDistance))
+				fMaxDistance = func(i);
+		}
+		return;
+	}
+
+	for (int plane : m_Broadphase.GetUnbounded())
+		fMaxDistance = func(plane);
+
+	m_Broadphase.QueryRay(origin, direction, fMaxDistance, func);
+}
+
+bool PhysicsScene::Raycast(vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit, uint32_t uLayerMask) const
+{
+	if (direction == vec2(0, 0))
+		return false;
+
+	vec2 unitDirection = normalize(direction);
+	bool bHit = false;
+
+	ForEachRayCandidate(origin, unitDirection, fMaxDistance, [&](int actor)
+	{
+		if ((m_actors[actor]->GetCategory() & uLayerMask) == 0)
+			return fMaxDistance;
+
+		RaycastHit actorHit;
+		bool bActorHit = std::visit([&](auto* pShape) { return SceneQuery::Raycast(pShape, origin, unitDirection, fMaxDistance, actorHit); }, m_shapes[actor]);
+
+		if (bActorHit)
+		{
+			hit = actorHit;
+			hit.pActor = m_actors[actor];
+			fMaxDistance = actorHit.fDistance;
+			bHit = true;
+		}
+
+		return fMaxDistance;
+	});
+
+	return bHit;
+}
+
+int PhysicsScene::RaycastAll(vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit* hits, int maxHits, uint32_t uLayerMask) const
+{
+	if (direction == vec2(0, 0) || maxHits <= 0)
+		return 0;
+
+	vec2 unitDirection = normalize(direction);
+	int count = 0;
+
+	ForEachRayCandidate(origin, unitDirection, fMaxDistance, [&](int actor)
+	{
+		if ((m_actors[actor]->GetCategory() & uLayerMask) == 0)
+			return fMaxDistance;
+
+		RaycastHit actorHit;
+		bool bActorHit = std::visit([&](auto* pShape) { return SceneQuery::Raycast(pShape, origin, unitDirection, fMaxDistance, actorHit); }, m_shapes[actor]);
+
+		if (bActorHit)
+		{
+			actorHit.pActor = m_actors[actor];
+
+			// Insertion sort into the buffer, dropping the furthest when full
+			int i = count < maxHits ? count++ : maxHits - 1;
+			for (; i > 0 && hits[i - 1].fDistance > actorHit.fDistance; --i)
+				hits[i] = hits[i - 1];
+			hits[i] = actorHit;
+
+			// Once full only nearer hits than the furthest kept matter
+			if (count == maxHits)
+				fMaxDistance = hits[maxHits - 1].fDistance;
+		}
+
+		return fMaxDistance;
+	});
+
+	return count;
+}
+
+void PhysicsScene::RaycastBatch(RayQuery const* rays, RaycastHit* hits, int count) const
+{
+	int packetCount = (count + RayPacket::SIZE - 1) / RayPacket::SIZE;
+
+	m_pJobs->parallelFor(0, packetCount, PACKET_GRAIN, [&](int begin, int end)
+	{
+		for (int packet = begin; packet < end; ++packet)
+		{
+			int first = packet * RayPacket::SIZE;
+			RaycastPacket(rays + first, hits + first, glm::min(count - first, RayPacket::SIZE));
+		}
+	});
+}
+
+void PhysicsScene::RaycastPacket(RayQuery const* rays, RaycastHit* hits, int count) const
+{
+	// The tree's indices are out of date, test each ray on its own
+	if (m_bQueryTreeStale)
+	{
+		for (int lane = 0; lane < count; ++lane)
+		{
+			hits[lane] = RaycastHit();
+			Raycast(rays[lane].origin, rays[lane].direction, rays[lane].fMaxDistance, hits[lane], rays[lane].uLayerMask);
+		}
+		return;
+	}
+
+	RayPacket packet;
+	vec2 directions[RayPacket::SIZE];
+
+	for (int lane = 0; lane < RayPacket::SIZE; ++lane)
+	{
+		bool bActive = lane < count && rays[lane].direction != vec2(0, 0);
+		directions[lane] = bActive ? normalize(rays[lane].direction) : vec2(1, 0);
+
+		// Far beyond any scene, but finite so zero times it is never NaN
+		const float fHuge = 1e30f;
+		packet.originX[lane] = bActive ? rays[lane].origin.x : 0;
+		packet.originY[lane] = bActive ? rays[lane].origin.y : 0;
+		packet.invDirX[lane] = directions[lane].x != 0 ? 1.0f / directions[lane].x : fHuge;
+		packet.invDirY[lane] = directions[lane].y != 0 ? 1.0f / directions[lane].y : fHuge;
+		packet.maxDistance[lane] = bActive ? rays[lane].fMaxDistance : -1.0f;
+
+		if (lane < count)
+			hits[lane] = RaycastHit();
+	}
+
+	auto testActor = [&](int actor, int lane)
+	{
+		if ((m_actors[actor]->GetCategory() & rays[lane].uLayerMask) == 0)
+			return;
+
+		vec2 origin = { packet.originX[lane], packet.originY[lane] };
+		float fMaxDistance = packet.maxDistance[lane];
+
+		RaycastHit actorHit;
+		bool bActorHit = std::visit([&](auto* pShape) { return SceneQuery::Raycast(pShape, origin, directions[lane], fMaxDistance, actorHit); }, m_shapes[actor]);
+
+		if (bActorHit)
+		{
+			hits[lane] = actorHit;
+			hits[lane].pActor = m_actors[actor];
+			packet.maxDistance[lane] = actorHit.fDistance;
+		}
+	};
+
+	for (int plane : m_Broadphase.GetUnbounded())
+	{
+		for (int lane = 0; lane < count; ++lane)
+		{
+			if (packet.maxDistance[lane] >= 0)
+				testActor(plane, lane);
+		}
+	}
+
+	m_Broadphase.QueryRayPacket(packet, [&](int actor, int laneMask)
+	{
+		for (int lane = 0; lane < count; ++lane)
+		{
+			if (laneMask & (1 << lane))
+				testActor(actor, lane);
+		}
+	});
+}
+
+int PhysicsScene::OverlapPoint(vec2 const& point, PhysicsObject** results, int maxResults) const
+{
+	int count = 0;
+	ForEachQueryCandidate({ point, point }, [&](int actor)
+	{
+		if (count < maxResults && std::visit([&](auto* pShape) { return SceneQuery::OverlapPoint(pShape, point); }, m_shapes[actor]))
+			results[count++] = m_actors[actor];
+	});
+
+	return count;
+}
+
+int PhysicsScene::OverlapAABB(Bounds const& bounds, PhysicsObject** results, int maxResults) const
+{
+	int count = 0;
+	ForEachQueryCandidate(bounds, [&](int actor)
+	{
+		if (count < maxResults && std::visit([&](auto* pShape) { return SceneQuery::OverlapAABB(pShape, bounds); }, m_shapes[actor]))
+			results[count++] = m_actors[actor];
+	});
+
+	return count;
+}
+
+int PhysicsScene::OverlapCircle(vec2 const& center, float radius, PhysicsObject** results, int maxResults) const
+{
+	int count = 0;
+	ForEachQueryCandidate({ center - vec2(radius), center + vec2(radius) }, [&](int actor)
+	{
+		if (count < maxResults && std::visit([&](auto* pShape) { return SceneQuery::OverlapCircle(pShape, center, radius); }, m_shapes[actor]))
+			results[count++] = m_actors[actor];
+	});
+
+	return count;
+}
+
+bool PhysicsScene::ShapeCast(Sphere* sphere, vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask) const
+{
+	return ShapeCastShape(sphere, displacement, hit, uLayerMask);
+}
+
+bool PhysicsScene::ShapeCast(Box* box, vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask) const
+{
+	return ShapeCastShape(box, displacement, hit, uLayerMask);
+}
+
+bool PhysicsScene::ShapeCast(Poly* poly, vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask) const
+{
+	return ShapeCastShape(poly, displacement, hit, uLayerMask);
+}
+
+template <class S>
+bool PhysicsScene::ShapeCastShape(S* shape, vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask) const
+{
+	// Everything the shape could touch lies in the box around both ends of the sweep
+	Bounds const& bounds = shape->GetBounds();
+	Bounds swept = { glm::min(bounds.min, bounds.min + displacement), glm::max(bounds.max, bounds.max + displacement) };
+
+	bool bHit = false;
+	ForEachQueryCandidate(swept, [&](int actor)
+	{
+		if (m_actors[actor] == shape || (m_actors[actor]->GetCategory() & uLayerMask) == 0)
+			return;
+
+		ShapeCastHit actorHit;
+		bool bActorHit = std::visit([&](auto* pTarget) { return SceneQuery::ShapeCast(shape, displacement, pTarget, actorHit); }, m_shapes[actor]);
+
+		if (bActorHit && (!bHit || actorHit.fTime < hit.fTime))
+		{
+			hit = actorHit;
+			hit.pActor = m_actors[actor];
+			bHit = true;
+		}
+	});
+
+	return bHit;
+}
+
+void PhysicsScene::BuildStepGraph()
+{
+	TaskGraph::CountFunc actorCount = [this]() { return (int)m_actors.size(); };
+
+	int integrate = m_StepGraph.AddParallelTask("integrate", actorCount, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+			m_actors[i]->fixedUpdate(m_gravity, m_timeStep);
+	}, ACTOR_GRAIN);
+
+	int bounds = m_StepGraph.AddParallelTask("bounds", actorCount, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+			m_actors[i]->UpdateBounds();
+	}, ACTOR_GRAIN);
+
+	int broadphase = m_StepGraph.AddTask("broadphase", [this]() { FindCollisionPairs(); });
+	int islands = m_StepGraph.AddTask("islands", [this]()
+	{
+		if (m_ResolutionMode == ResolutionMode::Jacobi)
+			BuildBodyPairs();
+		else
+			BuildIslands();
+	});
+
+	// Narrowphase and resolution stay together per island, a pair's test
+	// depends on how the pairs before it moved the bodies
+	int solve = m_StepGraph.AddParallelTask("solve", [this]() { return m_islandCount; }, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+			SolveIsland(i);
+	}, 1);
+
+	// Jacobi mode has no islands, so the solve above has nothing to do.
+	// Every pair reads the bodies as they were, then each body gathers its
+	// own pairs, so neither pass writes anything another chunk reads.
+	int jacobiPairs = m_StepGraph.AddParallelTask("jacobi pairs", [this]()
+	{
+		return m_ResolutionMode == ResolutionMode::Jacobi ? (int)m_Pairs.size() : 0;
+	}, [this](int begin, int end)
+	{
+		for (int pair = begin; pair < end; ++pair)
+		{
+			if (!IsSensorPair(pair))
+				SolveJacobiPair(pair);
+		}
+	}, PAIR_GRAIN);
+
+	int jacobiBodies = m_StepGraph.AddParallelTask("jacobi bodies", [this]()
+	{
+		return m_ResolutionMode == ResolutionMode::Jacobi ? (int)m_actors.size() : 0;
+	}, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+			ApplyJacobi(i);
+	}, ACTOR_GRAIN);
+
+	// After the solve so sensors see where bodies were resolved to, and
+	// before capture rewrites the bounds they read
+	int sensors = m_StepGraph.AddParallelTask("sensors", [this]() { return (int)m_SensorPairs.size(); }, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+			TestSensorPair(m_SensorPairs[i]);
+	}, SENSOR_GRAIN);
+
+	int contacts = m_StepGraph.AddTask("contacts", [this]() { BuildContactEvents(); });
+
+	// Resolution moved bodies since their bounds were taken, bound them
+	// again so queries between steps see where they ended up
+	int capture = m_StepGraph.AddParallelTask("capture", actorCount, [this](int begin, int end)
+	{
+		CaptureStates(begin, end);
+		for (int i = begin; i < end; ++i)
+			m_actors[i]->UpdateBounds();
+	}, ACTOR_GRAIN);
+
+	int refit = m_StepGraph.AddTask("refit", [this]()
+	{
+		m_Broadphase.Refit(m_actors);
+		m_bQueryTreeStale = false;
+	});
+
+	int hash = m_StepGraph.AddTask("hash", [this]()
+	{
+		if (m_bDeterministic)
+			HashStates();
+	});
+
+	m_StepGraph.AddDependency(bounds, integrate);
+	m_StepGraph.AddDependency(broadphase, bounds);
+	m_StepGraph.AddDependency(islands, broadphase);
+	m_StepGraph.AddDependency(solve, islands);
+	m_StepGraph.AddDependency(jacobiPairs, islands);
+	m_StepGraph.AddDependency(jacobiBodies, jacobiPairs);
+	m_StepGraph.AddDependency(sensors, solve);
+	m_StepGraph.AddDependency(sensors, jacobiBodies);
+	m_StepGraph.AddDependency(contacts, sensors);
+	m_StepGraph.AddDependency(capture, sensors);
+	m_StepGraph.AddDependency(refit, capture);
+	m_StepGraph.AddDependency(hash, capture);
+}
+
+void PhysicsScene::BuildContactEvents()
+{
+	m_NextContacts.clear();
+	for (int pair = 0; pair < (int)m_Pairs.size(); ++pair)
+	{
+		CollisionInfo const& info = m_PairContacts[pair];
+		if (!info.bCollision)
+			continue;
+
+		PhysicsObject* pA = m_actors[m_Pairs[pair].a];
+		PhysicsObject* pB = m_actors[m_Pairs[pair].b];
+		uint32_t uA = pA->GetID();
+		uint32_t uB = pB->GetID();
+		vec2 normal = info.collNormal;
+		if (uA > uB)
+		{
+			std::swap(uA, uB);
+			normal = -normal;
+		}
+
+		m_NextContacts.push_back({ ((uint64_t)uA << 32) | uB, normal, info.fPenetration, pA->IsSensor() || pB->IsSensor() });
+	}
+
+	// Pairs are already in ID order in deterministic mode, and close to it otherwise
+	std::sort(m_NextContacts.begin(), m_NextContacts.end(), [](ContactRecord const& lhs, ContactRecord const& rhs)
+	{
+		return lhs.uKey < rhs.uKey;
+	});
+
+	// Merge the two sorted lists, a key in only the old one has ended, in only
+	// the new one has begun
+	int last = 0;
+	int next = 0;
+	int lastCount = (int)m_Contacts.size();
+	int nextCount = (int)m_NextContacts.size();
+
+	while (last < lastCount || next < nextCount)
+	{
+		ContactEvent event;
+		event.uStep = m_uStepCount;
+
+		if (next == nextCount || (last < lastCount && m_Contacts[last].uKey < m_NextContacts[next].uKey))
+		{
+			ContactRecord const& contact = m_Contacts[last++];
+			event.type = ContactEvent::Type::End;
+			event.uActorA = (uint32_t)(contact.uKey >> 32);
+			event.uActorB = (uint32_t)contact.uKey;
+			event.normal = { 0,0 };
+			event.fPenetration = 0;
+			event.bSensor = contact.bSensor;
+		}
+		else
+		{
+			ContactRecord const& contact = m_NextContacts[next];
+			event.type = ContactEvent::Type::Begin;
+			if (last < lastCount && m_Contacts[last].uKey == contact.uKey)
+			{
+				event.type = ContactEvent::Type::Persist;
+				++last;
+			}
+
+			event.uActorA = (uint32_t)(contact.uKey >> 32);
+			event.uActorB = (uint32_t)contact.uKey;
+			event.normal = contact.normal;
+			event.fPenetration = contact.fPenetration;
+			event.bSensor = contact.bSensor;
+			++next;
+		}
+
+		m_ContactEvents.push_back(event);
+	}
+
+	std::swap(m_Contacts, m_NextContacts);
+}
+
+void PhysicsScene::UpdateGizmos()
+{
+	// While a step may be running on the worker, draw the snapshot taken
+	// when it began rather than the actors and states it is writing
+	if (m_bAsync)
+		DrawStates(m_renderActors, m_renderPrevStates, m_renderCurrStates, m_fRenderAlpha);
+	else
+		DrawStates(m_actors, m_prevStates, m_currStates, GetInterpolationAlpha());
+}
+
+void PhysicsScene::DrawStates(vector<PhysicsObject*> const& actors, vector<BodyState> const& prevStates, vector<BodyState> const& currStates, float alpha)
+{
+	for (int i = 0; i < (int)actors.size(); ++i)
+	{
+		if (actors[i]->getShapeID() == ShapeID::Plane)
+		{
+			actors[i]->makeGizmo();
+			continue;
+		}
+
+		// Draw the body part way between the last two steps, by how far the
+		// accumulator is into the next one
+		RigidBody* pBody = (RigidBody*)actors[i];
+		pBody->DrawGizmo(LerpState(prevStates[i], currStates[i], alpha));
+	}
+}
+
+void PhysicsScene::BeginStep(float dt)
+{
+	EndStep();
+
+	m_renderActors = m_actors;
+	m_renderPrevStates = m_prevStates;
+	m_renderCurrStates = m_currStates;
+	m_fRenderAlpha = GetInterpolationAlpha();
+	m_bAsync = true;
+
+	// Nothing drawn from here on can hold the actors the last step removed
+	DeleteRemovedActors();
+
+	std::lock_guard<std::mutex> lock(m_StepMutex);
+	if (!m_StepThread.joinable())
+		m_StepThread = std::thread(&PhysicsScene::StepWorker, this);
+
+	m_fPendingDt = dt;
+	m_bStepPending = true;
+	m_StepCondition.notify_all();
+}
+
+void PhysicsScene::DeleteRemovedActors()
+{
+	for (PhysicsObject* actor : m_RemovedActors)
+		delete actor;
+	m_RemovedActors.clear();
+}
+
+void PhysicsScene::EndStep()
+{
+	std::unique_lock<std::mutex> lock(m_StepMutex);
+	m_StepCondition.wait(lock, [this]() { return !m_bStepPending; });
+}
+
+void PhysicsScene::StepWorker()
+{
+	std::unique_lock<std::mutex> lock(m_StepMutex);
+	while (true)
+	{
+		m_StepCondition.wait(lock, [this]() { return m_bStepPending || m_bStopWorker; });
+		if (m_bStopWorker)
+			return;
+
+		float dt = m_fPendingDt;
+		lock.unlock();
+		Update(dt);
+		lock.lock();
+
+		m_bStepPending = false;
+		m_StepCondition.notify_all();
+	}
+}
+
+void PhysicsScene::CaptureStates(int begin, int end)
+{
+	for (int i = begin; i < end; ++i)
+	{
+		if (m_actors[i]->getShapeID() == ShapeID::Plane)
+			continue;
+
+		m_prevStates[i] = m_currStates[i];
+		m_currStates[i] = ((RigidBody*)m_actors[i])->GetState();
+	}
+}
+
+void PhysicsScene::checkForCollision()
+{
+	FindCollisionPairs();
+
+	if (m_ResolutionMode == ResolutionMode::Jacobi)
+	{
+		BuildBodyPairs();
+		for (int pair = 0; pair < (int)m_Pairs.size(); ++pair)
+		{
+			if (!IsSensorPair(pair))
+				SolveJacobiPair(pair);
+		}
+
+		for (int i = 0; i < (int)m_actors.size(); ++i)
+			ApplyJacobi(i);
+	}
+	else
+	{
+		BuildIslands();
+		for (int i = 0; i < m_islandCount; ++i)
+			SolveIsland(i);
+	}
+
+	for (int pair : m_SensorPairs)
+		TestSensorPair(pair);
+}
+
+void PhysicsScene::BuildIslands()
+{
+	int actorCount = (int)m_actors.size();
+	int pairCount = (int)m_Pairs.size();
+
+	// Union the bodies of every pair. Planes are only read by a solve, so
+	// they do not join islands. Sensor pairs are tested after every island
+	// is solved, outside them.
+	m_IslandParent.resize(actorCount);
+	for (int i = 0; i < actorCount; ++i)
+		m_IslandParent[i] = i;
+
+	for (int pair = 0; pair < pairCount; ++pair)
+	{
+		int a = m_Pairs[pair].a;
+		int b = m_Pairs[pair].b;
+		if (m_shapes[a].index() == (int)ShapeID::Plane || m_shapes[b].index() == (int)ShapeID::Plane ||
+			IsSensorPair(pair))
+			continue;
+
+		int rootA = FindIsland(a);
+		int rootB = FindIsland(b);
+		if (rootA != rootB)
+			m_IslandParent[rootB] = rootA;
+	}
+
+	// Number the islands in order of their first pair, then bucket the pairs
+	// so each island keeps them in sorted order
+	m_IslandOfRoot.assign(actorCount, -1);
+	m_PairIsland.resize(pairCount);
+	m_IslandStart.assign(pairCount + 1, 0);
+	m_islandCount = 0;
+	m_SensorPairs.clear();
+
+	for (int pair = 0; pair < pairCount; ++pair)
+	{
+		if (IsSensorPair(pair))
+		{
+			m_PairIsland[pair] = -1;
+			m_SensorPairs.push_back(pair);
+			continue;
+		}
+
+		int body = m_Pairs[pair].a;
+		if (m_shapes[body].index() == (int)ShapeID::Plane)
+			body = m_Pairs[pair].b;
+
+		int root = FindIsland(body);
+		if (m_IslandOfRoot[root] < 0)
+			m_IslandOfRoot[root] = m_islandCount++;
+
+		m_PairIsland[pair] = m_IslandOfRoot[root];
+		++m_IslandStart[m_PairIsland[pair] + 1];
+	}
+
+	for (int i = 0; i < m_islandCount; ++i)
+		m_IslandStart[i + 1] += m_IslandStart[i];
+
+	m_IslandPairs.resize(pairCount - m_SensorPairs.size());
+	for (int pair = 0; pair < pairCount; ++pair)
+	{
+		if (m_PairIsland[pair] >= 0)
+			m_IslandPairs[m_IslandStart[m_PairIsland[pair]]++] = pair;
+	}
+
+	// Filling moved every start up to the next island's, shift them back
+	for (int i = m_islandCount; i > 0; --i)
+		m_IslandStart[i] = m_IslandStart[i - 1];
+	m_IslandStart[0] = 0;
+
+	FindPairCaches();
+}
+
+void PhysicsScene::FindPairCaches()
+{
+	int pairCount = (int)m_Pairs.size();
+
+	// Look up the SAT caches now, pairs are solved in parallel and the
+	// table cannot grow under them
+	m_SATCache.Reserve(m_SATCache.GetCount() + pairCount);
+	m_PairCaches.resize(pairCount);
+	m_PairContacts.resize(pairCount);
+	for (int pair = 0; pair < pairCount; ++pair)
+	{
+		int a = m_Pairs[pair].a;
+		int b = m_Pairs[pair].b;
+
+		// Only the SAT tests between boxes and polys keep per pair state
+		m_PairCaches[pair] = nullptr;
+		if (!IsSensorPair(pair) && UsesSATCache((int)m_shapes[a].index(), (int)m_shapes[b].index()))
+			m_PairCaches[pair] = &m_SATCache.FindOrAdd(m_actors[a]->GetID(), m_actors[b]->GetID());
+	}
+}
+
+void PhysicsScene::BuildBodyPairs()
+{
+	int actorCount = (int)m_actors.size();
+	int pairCount = (int)m_Pairs.size();
+
+	m_islandCount = 0;
+	m_SensorPairs.clear();
+
+	// Bucket every pair under each of its bodies, in pair order, so a body
+	// sums its contacts the same way whichever thread gathers it
+	m_BodyPairStart.assign(actorCount + 1, 0);
+	for (int pair = 0; pair < pairCount; ++pair)
+	{
+		if (IsSensorPair(pair))
+		{
+			m_SensorPairs.push_back(pair);
+			continue;
+		}
+
+		++m_BodyPairStart[m_Pairs[pair].a + 1];
+		++m_BodyPairStart[m_Pairs[pair].b + 1];
+	}
+
+	for (int i = 0; i < actorCount; ++i)
+		m_BodyPairStart[i + 1] += m_BodyPairStart[i];
+
+	m_BodyPairs.resize(m_BodyPairStart[actorCount]);
+	for (int pair = 0; pair < pairCount; ++pair)
+	{
+		if (IsSensorPair(pair))
+			continue;
+
+		m_BodyPairs[m_BodyPairStart[m_Pairs[pair].a]++] = pair;
+		m_BodyPairs[m_BodyPairStart[m_Pairs[pair].b]++] = pair;
+	}
+
+	for (int i = actorCount; i > 0; --i)
+		m_BodyPairStart[i] = m_BodyPairStart[i - 1];
+	m_BodyPairStart[0] = 0;
+
+	m_PairResolutions.resize(pairCount);
+	FindPairCaches();
+}
+
+int PhysicsScene::FindIsland(int actor)
+{
+	while (m_IslandParent[actor] != actor)
+	{
+		m_IslandParent[actor] = m_IslandParent[m_IslandParent[actor]];
+		actor = m_IslandParent[actor];
+	}
+
+	return actor;
+}
+
+void PhysicsScene::SolveIsland(int island)
+{
+	for (int i = m_IslandStart[island]; i < m_IslandStart[island + 1]; ++i)
+	{
+		int pair = m_IslandPairs[i];
+		int index1 = m_Pairs[pair].a;
+		int index2 = m_Pairs[pair].b;
+		SATCache* pCache = m_PairCaches[pair];
+
+		// Both shapes are known here, so this reaches the typed Collide and
+		// Resolve overloads with no casts or shape checks in between
+		std::visit([&](auto* pShape1, auto* pShape2)
+		{
+			CollisionInfo info = Collide(pShape1, pShape2, pCache);
+			if (info.bCollision)
+				Resolve(info, pShape1, pShape2);
+
+			m_PairContacts[pair] = info;
+		}, m_shapes[index1], m_shapes[index2]);
+	}
+}
+
+void PhysicsScene::SolveJacobiPair(int pair)
+{
+	int index1 = m_Pairs[pair].a;
+	int index2 = m_Pairs[pair].b;
+	SATCache* pCache = m_PairCaches[pair];
+
+	std::visit([&](auto* pShape1, auto* pShape2)
+	{
+		CollisionInfo info = Collide(pShape1, pShape2, pCache);
+		m_PairContacts[pair] = info;
+		if (info.bCollision)
+			ComputeResolution(info, pShape1, pShape2, m_PairResolutions[pair]);
+	}, m_shapes[index1], m_shapes[index2]);
+}
+
+void PhysicsScene::ApplyJacobi(int actor)
+{
+	if (m_actors[actor]->getShapeID() == ShapeID::Plane)
+		return;
+
+	RigidBody* pBody = (RigidBody*)m_actors[actor];
+	vec2 offset = { 0,0 };
+
+	for (int i = m_BodyPairStart[actor]; i < m_BodyPairStart[actor + 1]; ++i)
+	{
+		int pair = m_BodyPairs[i];
+		if (!m_PairContacts[pair].bCollision)
+			continue;
+
+		PairResolution const& resolution = m_PairResolutions[pair];
+		bool bFirst = m_Pairs[pair].a == actor;
+		pBody->AddResolutionForce(bFirst ? resolution.force1 : resolution.force2);
+		offset += bFirst ? resolution.offset1 : resolution.offset2;
+	}
+
+	pBody->ApplyResolutionForce();
+	if (offset != vec2(0, 0))
+		pBody->setPosition(pBody->getPosition() - offset);
+}
+
+void PhysicsScene::ComputeResolution(CollisionInfo const& info, Plane* plane1, RigidBody* rb2, PairResolution& resolution)
+{
+	resolution.force1 = { 0,0 };
+	RestitutionOffsets(info.fPenetration, info.collNormal, rb2, nullptr, resolution.offset2, resolution.offset1);
+	resolution.force2 = plane1->ResolutionForce(rb2, info.collNormal);
+}
+
+void PhysicsScene::ComputeResolution(CollisionInfo const& info, RigidBody* rb1, Plane* plane2, PairResolution& resolution)
+{
+	resolution.force2 = { 0,0 };
+	RestitutionOffsets(info.fPenetration, info.collNormal, rb1, nullptr, resolution.offset1, resolution.offset2);
+	resolution.force1 = plane2->ResolutionForce(rb1, info.collNormal);
+}
+
+void PhysicsScene::ComputeResolution(CollisionInfo const& info, RigidBody* rb1, RigidBody* rb2, PairResolution& resolution)
+{
+	RestitutionOffsets(info.fPenetration, info.collNormal, rb1, rb2, resolution.offset1, resolution.offset2);
+	resolution.force2 = rb1->ResolutionForce(rb2, info.collNormal);
+	resolution.force1 = -resolution.force2;
+}
+
+void PhysicsScene::TestSensorPair(int pair)
+{
+	CollisionInfo info;
+	info.bCollision = std::visit([](auto* pShape1, auto* pShape2)
+	{
+		return SensorOverlap(pShape1, pShape2);
+	}, m_shapes[m_Pairs[pair].a], m_shapes[m_Pairs[pair].b]);
+
+	m_PairContacts[pair] = info;
+}
+
+template <class A, class B>
+bool PhysicsScene::SensorOverlap(A* pShape1, B* pShape2)
+{
+	// Spheres and boxes are a circle and an AABB, the query overlap tests take
+	// either without working out a normal. Two hulls use the narrowphase.
+	if constexpr (std::is_same<A, Sphere>::value)
+		return SceneQuery::OverlapCircle(pShape2, pShape1->getPosition(), pShape1->getRadius());
+	else if constexpr (std::is_same<B, Sphere>::value)
+		return SceneQuery::OverlapCircle(pShape1, pShape2->getPosition(), pShape2->getRadius());
+	else if constexpr (std::is_same<A, Box>::value)
+		return SceneQuery::OverlapAABB(pShape2, pShape1->GetBounds());
+	else if constexpr (std::is_same<B, Box>::value)
+		return SceneQuery::OverlapAABB(pShape1, pShape2->GetBounds());
+	else
+		return Collide(pShape1, pShape2).bCollision;
+}
+
+void PhysicsScene::Resolve(CollisionInfo const& info, Plane* plane1, RigidBody* rb2)
+{
+	Restitution(info.fPenetration, info.collNormal, rb2);
+	plane1->resolveCollision(rb2, info.collNormal);
+
+	// DEBUG
+	rb2->InvertIsFilled();
+}
+
+void PhysicsScene::Resolve(CollisionInfo const& info, RigidBody* rb1, Plane* plane2)
+{
+	Restitution(info.fPenetration, info.collNormal, rb1);
+	plane2->resolveCollision(rb1, info.collNormal);
+
+	// DEBUG
+	rb1->InvertIsFilled();
+}
+
+void PhysicsScene::Resolve(CollisionInfo const& info, RigidBody* rb1, RigidBody* rb2)
+{
+	Restitution(info.fPenetration, info.collNormal, rb1, rb2);
+	rb1->resolveCollision(rb2, info.collNormal);
+
+	// DEBUG
+	rb1->InvertIsFilled();
+	rb2->InvertIsFilled();
+}
+
+void PhysicsScene::FindCollisionPairs()
+{
+	m_Pairs.clear();
+
+	m_Broadphase.Build(m_actors);
+	m_Broadphase.FindPairs(m_Pairs);
+
+	// Planes are unbounded so they stay out of the tree, test them against
+	// each body's bounds directly
+	int actorCount = (int)m_actors.size();
+	for (int i = 0; i < actorCount; ++i)
+	{
+		if (m_actors[i]->getShapeID() != ShapeID::Plane)
+			continue;
+
+		Plane* plane = (Plane*)m_actors[i];
+		CollisionFilter const& filter = plane->GetCollisionFilter();
+		for (int j = 0; j < actorCount; ++j)
+		{
+			if (m_actors[j]->getShapeID() == ShapeID::Plane || !ShouldCollide(filter, m_actors[j]->GetCollisionFilter()))
+				continue;
+
+			if (plane->OverlapsBounds(m_actors[j]->GetBounds()))
+				m_Pairs.push_back({ std::min(i, j), std::max(i, j) });
+		}
+	}
+
+	// Keep testing pairs in actor order, resolution depends on it. Actor
+	// indices shift as actors come and go, deterministic mode uses the IDs.
+	if (m_bDeterministic)
+	{
+		std::sort(m_Pairs.begin(), m_Pairs.end(), [this](BroadphasePair const& lhs, BroadphasePair const& rhs)
+		{
+			uint32_t lhsA = m_actors[lhs.a]->GetID();
+			uint32_t lhsB = m_actors[lhs.b]->GetID();
+			uint32_t rhsA = m_actors[rhs.a]->GetID();
+			uint32_t rhsB = m_actors[rhs.b]->GetID();
+			if (lhsA > lhsB)
+				std::swap(lhsA, lhsB);
+			if (rhsA > rhsB)
+				std::swap(rhsA, rhsB);
+
+			return lhsA < rhsA || (lhsA == rhsA && lhsB < rhsB);
+		});
+	}
+	else
+	{
+		std::sort(m_Pairs.begin(), m_Pairs.end(), [](BroadphasePair const& lhs, BroadphasePair const& rhs)
+		{
+			return lhs.a < rhs.a || (lhs.a == rhs.a && lhs.b < rhs.b);
+		});
+	}
+}
+
+static inline uint64_t HashWord(uint64_t hash, uint32_t word)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		hash ^= (word >> (i * 8)) & 0xFF;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+static inline uint64_t HashFloat(uint64_t hash, float value)
+{
+	uint32_t word;
+	memcpy(&word, &value, sizeof(word));
+	return HashWord(hash, word);
+}
+
+void PhysicsScene::HashStates()
+{
+	uint64_t hash = HashWord(m_uStateHash, m_uStepCount);
+
+	for (int i = 0; i < (int)m_actors.size(); ++i)
+	{
+		if (m_actors[i]->getShapeID() == ShapeID::Plane)
+			continue;
+
+		RigidBody* pBody = (RigidBody*)m_actors[i];
+		vec2 position = pBody->getPosition();
+		vec2 velocity = pBody->getVelocity();
+
+		hash = HashWord(hash, pBody->GetID());
+		hash = HashFloat(hash, position.x);
+		hash = HashFloat(hash, position.y);
+		hash = HashFloat(hash, pBody->getRotation());
+		hash = HashFloat(hash, velocity.x);
+		hash = HashFloat(hash, velocity.y);
+		hash = HashFloat(hash, pBody->getAngularVelocity());
+	}
+
+	m_uStateHash = hash;
+}
+
+CollisionInfo PhysicsScene::Collide(Plane* plane1, Plane* plane2, SATCache* pCache)
+{
+	CollisionInfo result;
+	result.bCollision = false;
+	return result;
+}
+
+CollisionInfo PhysicsScene::Collide(Plane* plane1, Sphere* sphere2, SATCache* pCache)
+{
+	CollisionInfo result;
+	result.bCollision = false;
+
+	vec2 collisionNormal = plane1->getNormal();
+	float sphereToPlane = dot(sphere2->getPosition(), plane1->getNormal()) - plane1->getDistance();
+
+	if (sphereToPlane < 0)
+	{
+		collisionNormal *= -1;
+		sphereToPlane *= -1;
+	}
+
+	float intersection = sphere2->getRadius() - sphereToPlane;
+	if (intersection > 0)
+	{
+		result.collNormal = collisionNormal;
+		result.bCollision = true;
+		result.fPenetration = intersection;
+
+		return result;
+	}
+	return result;
+}
+
+CollisionInfo PhysicsScene::Collide(Plane* plane1, Box* box2, SATCache* pCache)
+{
+	CollisionInfo result;
+	result.bCollision = false;
+
+	vec2 collNorm = plane1->getNormal();
+
+	vec2 boxPos = box2->getPosition();
+	vec2 boxExtent = box2->getExtents();
+
+	float r = (boxExtent[0] * abs(collNorm[0])) + (boxExtent[1] * abs(collNorm[1]));
+	float s = dot(collNorm, boxPos) - plane1->getDistance();
+
+	float pen = r - abs(s);
+
+	result.bCollision = pen >= 0;
+	if (result.bCollision)
+	{
+		result.fPenetration = pen;
+		result.collNormal = -collNorm;
+	}
+	return result;
+}
+
+CollisionInfo PhysicsScene::Collide(Plane* plane1, Poly* poly2, SATCache* pCache)
+{
+	// Early out on the bounding circle
+	vec2 boundCenter = poly2->GetBoundCenter();
+	if (abs(dot(boundCenter, plane1->getNormal()) - plane1->getDistance()) >= poly2->GetBoundRadius())
+		return CollisionInfo();
+
+	// Perform SAT check
+	CollisionInfo sat;
+	sat.collNormal = plane1->getNormal();
+
+	float polyMax, polyMin;
+	poly2->Project(sat.collNormal, polyMin, polyMax);
+
+	float planeDistance = plane1->getDistance();
+	sat.bCollision = ProjectionOverlap(planeDistance, planeDistance, polyMin, polyMax, sat.fPenetration);
+
+	sat.fPenetration -= (polyMax - polyMin);
+
+	return sat;
+}
+
+CollisionInfo PhysicsScene::Collide(Plane* plane1, Stitched* stitched1, SATCache* pCache)
+{
+	ContactBlend blend;
+	int count = stitched1->GetPolyCount();
+
+	for (int i = 0; i < count; ++i)
+	{
+		blend.Add(Collide(plane1, stitched1->GetPoly(i)));
+	}
+
+	return blend.Result();
+}
+
+CollisionInfo PhysicsScene::Collide(Sphere* sphere1, Plane* plane2, SATCache* pCache)
+{
+	return Collide(plane2, sphere1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Sphere* sphere1, Sphere* sphere2, SATCache* pCache)
+{
+	CollisionInfo result;
+	result.bCollision = false;
+
+	float seperation = glm::distance(sphere1->getPosition(), sphere2->getPosition());
+	float fRadiusSum = sphere1->getRadius() + sphere2->getRadius();
+
+	// IF collision
+	if (seperation < fRadiusSum)
+	{
+		float pen = seperation - fRadiusSum;
+
+		result.fPenetration = pen;
+		result.collNormal = normalize(sphere1->getPosition() - sphere2->getPosition());
+		result.bCollision = true;
+
+		return result;
+	}
+
+	return result;
+}
+
+CollisionInfo PhysicsScene::Collide(Sphere* sphere1, Box* box2, SATCache* pCache)
+{
+	CollisionInfo result;
+	result.bCollision = false;
+
+	vec2 boxMax = box2->getPosition() + box2->getExtents();
+	vec2 boxMin = box2->getPosition() - box2->getExtents();
+
+	vec2 spherePos = sphere1->getPosition();
+	vec2 v2Clamp = clamp(spherePos, boxMin, boxMax);
+
+	v2Clamp -= spherePos;		
+	if (length(v2Clamp) <= sphere1->getRadius())
+	{
+		float pen = length(v2Clamp) - sphere1->getRadius();
+		
+		if (v2Clamp == vec2(0, 0))
+			result.collNormal = normalize(spherePos - box2->getPosition());
+		else
+			result.collNormal = normalize(v2Clamp);
+
+		result.bCollision = true;
+		result.fPenetration = pen;
+		
+		return result;
+	}
+	return result;
+}
+
+CollisionInfo PhysicsScene::Collide(Sphere* sphere1, Poly* poly2, SATCache* pCache)
+{
+	// Early out on the bounding circle
+	float radiusSum = sphere1->getRadius() + poly2->GetBoundRadius();
+	if (distance(sphere1->getPosition(), poly2->GetBoundCenter()) >= radiusSum)
+		return CollisionInfo();
+
+	// Perform SAT check
+	CollisionInfo sat;
+	sat.fPenetration = FLT_MAX;
+
+	float sphereDot, sphereMax, sphereMin;
+	float polyMax, polyMin;
+	float overlap;
+
+	for (int i = 0; i < poly2->GetSNormCount(); ++i)
+	{
+		if (poly2->GetSNormParallel(i))
+			continue;
+
+		vec2 norm = poly2->GetRotatedSNorm(i);
+
+		sphereDot = dot(norm, sphere1->getPosition());
+		sphereMax = sphereDot + sphere1->getRadius();
+		sphereMin = sphereDot - sphere1->getRadius();
+
+		poly2->Project(norm, polyMin, polyMax);
+
+		sat.bCollision = ProjectionOverlap(sphereMin, sphereMax, polyMin, polyMax, overlap);
+
+		//No collision EARLY EXIT
+		if (!(sat.bCollision))
+			return sat;
+
+		overlap -= (polyMax - polyMin);
+		overlap -= (sphereMax - sphereMin);
+
+		overlap = abs(overlap);
+
+		if (sat.fPenetration > overlap)
+		{
+			sat.fPenetration = overlap;
+			sat.collNormal = norm;
+		}
+	}
+
+	return sat;
+}
+
+CollisionInfo PhysicsScene::Collide(Sphere* sphere1, Stitched* stitched1, SATCache* pCache)
+{
+	ContactBlend blend;
+
+	// Only the sub-polys whose cooked bounds reach the sphere can touch it
+	stitched1->ForEachPolyNear(sphere1->getPosition(), sphere1->getRadius(), [&](int i)
+	{
+		blend.Add(Collide(sphere1, stitched1->GetPoly(i)));
+	});
+
+	return blend.Result();
+}
+
+CollisionInfo PhysicsScene::Collide(Box* box1, Plane* plane2, SATCache* pCache)
+{
+	return Collide(plane2, box1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Box* box1, Sphere* sphere2, SATCache* pCache)
+{
+	return Collide(sphere2, box1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Box* box1, Box* box2, SATCache* pCache)
+{
+	CollisionInfo result;
+	result.bCollision = false;
+
+	vec2 box1Pos = box1->getPosition();
+	vec2 box2Pos = box2->getPosition();
+
+	vec2 box1Min = box1Pos - box1->getExtents();
+	vec2 box1Max = box1Pos + box1->getExtents();
+	vec2 box2Min = box2Pos - box2->getExtents();
+	vec2 box2Max = box2Pos + box2->getExtents();
+
+	static const vec2 faces[4] =
+	{
+		vec2(-1,  0), // 'left' face normal (-x direction)
+		vec2(1,  0), // 'right' face normal (+x direction)
+		vec2(0, -1), // 'bottom' face normal (-y direction)
+		vec2(0,  1), // 'top' face normal (+y direction)
+	};
+
+	float distances[4] =
+	{
+		(box2Max.x - box1Min.x), // distance of box 'b' to face on 'left' side of 'a'.
+		(box1Max.x - box2Min.x), // distance of box 'b' to face on 'right' side of 'a'.
+		(box2Max.y - box1Min.y), // distance of box 'b' to face on 'bottom' side of 'a'.
+		(box1Max.y - box2Min.y), // distance of box 'b' to face on 'top' side of 'a'.
+	};
+
+	vec2 collisionNormal;
+	float pen;
+
+	for (int i = 0; i < 4; i++)
+	{
+		// box does not intersect face. So boxes don't intersect at all.
+		if (distances[i] < 0.0f || distances[i] != distances[i])
+			return result;
+
+		// face of least intersection depth. That's our candidate.
+		if ((i == 0) || (distances[i] < pen))
+		{
+			collisionNormal = faces[i];
+			pen = distances[i];
+		}
+	}
+
+	result.collNormal = collisionNormal;
+	result.bCollision = true;
+	result.fPenetration = pen;
+	
+	return result;
+}
+
+CollisionInfo PhysicsScene::Collide(Box* box1, Poly* poly2, SATCache* pCache)
+{
+	// Early out on the bounding box
+	Bounds boxBounds = { box1->getPosition() - box1->getExtents(), box1->getPosition() + box1->getExtents() };
+	if (!BoundsOverlap(boxBounds, poly2->GetBounds()))
+		return CollisionInfo();
+
+	// Perform SAT check
+	CollisionInfo sat;
+	sat.fPenetration = FLT_MAX;
+
+	float overlap;
+
+	vec2 boxPos = box1->getPosition();
+	vec2 boxExtent = box1->getExtents();
+
+	vec2 boxVerts[4] =
+	{
+		boxPos + boxExtent,
+		boxPos + vec2(boxExtent.x, -boxExtent.y),
+		boxPos + -boxExtent,
+		boxPos + vec2(-boxExtent.x, boxExtent.y)
+	};
+
+	// Axis 0 is the box's x axis, the rest are the poly's surface normals
+	static const vec2 boxNorm = vec2(1, 0);
+	int axisCount = 1 + poly2->GetSNormCount();
+
+	// Try last step's separating axis first, it usually still separates
+	int cachedAxis = pCache ? pCache->iAxis : -1;
+	if (cachedAxis >= axisCount)
+		cachedAxis = -1;
+
+	if (cachedAxis >= 0)
+	{
+		vec2 norm = (cachedAxis == 0) ? boxNorm : poly2->GetRotatedSNorm(cachedAxis - 1);
+
+		sat.bCollision = BoxPolyAxisOverlap(boxVerts, poly2, norm, overlap);
+
+		//No collision EARLY EXIT
+		if (!(sat.bCollision))
+			return sat;
+
+		sat.fPenetration = overlap;
+		sat.collNormal = norm;
+	}
+
+	int refAxis = cachedAxis;
+	for (int i = 0; i < axisCount; ++i)
+	{
+		if (i == cachedAxis || (i > 0 && poly2->GetSNormParallel(i - 1)))
+			continue;
+
+		vec2 norm = (i == 0) ? boxNorm : poly2->GetRotatedSNorm(i - 1);
+
+		sat.bCollision = BoxPolyAxisOverlap(boxVerts, poly2, norm, overlap);
+
+		//No collision EARLY EXIT
+		if (!(sat.bCollision))
+		{
+			if (pCache)
+				pCache->iAxis = i;
+			return sat;
+		}
+
+		if (sat.fPenetration > overlap)
+		{
+			sat.fPenetration = overlap;
+			sat.collNormal = norm;
+			refAxis = i;
+		}
+	}
+
+	if (pCache)
+		pCache->iAxis = refAxis;
+
+	return sat;
+}
+
+CollisionInfo PhysicsScene::Collide(Box* box1, Stitched* stitched1, SATCache* pCache)
+{
+	ContactBlend blend;
+
+	// Only the sub-polys whose cooked bounds reach the box can touch it
+	stitched1->ForEachPolyNear(box1->getPosition(), length(box1->getExtents()), [&](int i)
+	{
+		blend.Add(Collide(box1, stitched1->GetPoly(i)));
+	});
+
+	return blend.Result();
+}
+
+CollisionInfo PhysicsScene::Collide(Poly* poly1, Plane* plane2, SATCache* pCache)
+{
+	return Collide(plane2, poly1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Poly* poly1, Sphere* sphere2, SATCache* pCache)
+{
+	return Collide(sphere2, poly1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Poly* poly1, Box* box2, SATCache* pCache)
+{
+	return Collide(box2, poly1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Poly* poly1, Poly* poly2, SATCache* pCache)
+{
+	// Early out on the bounding boxes, then the bounding circles
+	if (!BoundsOverlap(poly1->GetBounds(), poly2->GetBounds()))
+		return CollisionInfo();
+
+	float radiusSum = poly1->GetBoundRadius() + poly2->GetBoundRadius();
+	if (distance(poly1->GetBoundCenter(), poly2->GetBoundCenter()) >= radiusSum)
+		return CollisionInfo();
+
+	// Perform SAT check
+	CollisionInfo sat;
+	sat.fPenetration = FLT_MAX;
+	
+	float overlap;
+
+	// Axes index poly1's surface normals first, then poly2's
+	int count1 = poly1->GetSNormCount();
+	int axisCount = count1 + poly2->GetSNormCount();
+
+	// Try last step's separating axis first, it usually still separates
+	int cachedAxis = pCache ? pCache->iAxis : -1;
+	if (cachedAxis >= axisCount)
+		cachedAxis = -1;
+
+	if (cachedAxis >= 0)
+	{
+		vec2 norm = (cachedAxis < count1) ? poly1->GetRotatedSNorm(cachedAxis) : poly2->GetRotatedSNorm(cachedAxis - count1);
+
+		sat.bCollision = PolyAxisOverlap(poly1, poly2, norm, overlap);
+
+		//No collision EARLY EXIT
+		if (!(sat.bCollision))
+			return sat;
+
+		sat.fPenetration = overlap;
+		sat.collNormal = norm;
+	}
+
+	int refAxis = cachedAxis;
+	for (int i = 0; i < axisCount; ++i)
+	{
+		if (i == cachedAxis)
+			continue;
+
+		bool bParallel = (i < count1) ? poly1->GetSNormParallel(i) : poly2->GetSNormParallel(i - count1);
+		if (bParallel)
+			continue;
+
+		vec2 norm = (i < count1) ? poly1->GetRotatedSNorm(i) : poly2->GetRotatedSNorm(i - count1);
+	
+		sat.bCollision = PolyAxisOverlap(poly1, poly2, norm, overlap);
+	
+		//No collision EARLY EXIT
+		if (!(sat.bCollision))
+		{
+			if (pCache)
+				pCache->iAxis = i;
+			return sat;
+		}
+	
+		if (sat.fPenetration > overlap)
+		{
+			sat.fPenetration = overlap;
+			sat.collNormal = norm;
+			refAxis = i;
+		}
+	}
+
+	if (pCache)
+		pCache->iAxis = refAxis;
+
+	return sat;
+}
+
+CollisionInfo PhysicsScene::Collide(Poly* poly1, Stitched* stitched1, SATCache* pCache)
+{
+	ContactBlend blend;
+
+	// Only the sub-polys whose cooked bounds reach the poly can touch it
+	stitched1->ForEachPolyNear(poly1->GetBoundCenter(), poly1->GetBoundRadius(), [&](int i)
+	{
+		blend.Add(Collide(poly1, stitched1->GetPoly(i)));
+	});
+
+	return blend.Result();
+}
+
+CollisionInfo PhysicsScene::Collide(Stitched* stitched1, Plane* plane2, SATCache* pCache)
+{
+	return Collide(plane2, stitched1);
+}
+
+CollisionInfo PhysicsScene::Collide(Stitched* stitched1, Sphere* sphere2, SATCache* pCache)
+{
+	return Collide(sphere2, stitched1);
+}
+
+CollisionInfo PhysicsScene::Collide(Stitched* stitched1, Box* box2, SATCache* pCache)
+{
+	return Collide(box2, stitched1);
+}
+
+CollisionInfo PhysicsScene::Collide(Stitched* stitched1, Poly* poly2, SATCache* pCache)
+{
+	return Collide(poly2, stitched1, pCache);
+}
+
+CollisionInfo PhysicsScene::Collide(Stitched* stitched1, Stitched* stitched2, SATCache* pCache)
+{
+	ContactBlend blend;
+	int count = stitched1->GetPolyCount();
+
+	for (int i = 0; i < count; ++i)
+	{
+		blend.Add(Collide(stitched1->GetPoly(i), stitched2));
+	}
+
+	return blend.Result();
+}
+
+CollisionInfo PhysicsScene::plane2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Plane*>(obj1), static_cast<Plane*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::plane2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Plane*>(obj1), static_cast<Sphere*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::plane2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Plane*>(obj1), static_cast<Box*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::plane2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Plane*>(obj1), static_cast<Poly*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::plane2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Plane*>(obj1), static_cast<Stitched*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::sphere2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Sphere*>(obj1), static_cast<Plane*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::sphere2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Sphere*>(obj1), static_cast<Sphere*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::sphere2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Sphere*>(obj1), static_cast<Box*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::sphere2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Sphere*>(obj1), static_cast<Poly*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::sphere2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Sphere*>(obj1), static_cast<Stitched*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::box2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Box*>(obj1), static_cast<Plane*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::box2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Box*>(obj1), static_cast<Sphere*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::box2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Box*>(obj1), static_cast<Box*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::box2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Box*>(obj1), static_cast<Poly*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::box2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Box*>(obj1), static_cast<Stitched*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::poly2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Poly*>(obj1), static_cast<Plane*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::poly2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Poly*>(obj1), static_cast<Sphere*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::poly2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Poly*>(obj1), static_cast<Box*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::poly2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Poly*>(obj1), static_cast<Poly*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::poly2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Poly*>(obj1), static_cast<Stitched*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::stitched2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Stitched*>(obj1), static_cast<Plane*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::stitched2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Stitched*>(obj1), static_cast<Sphere*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::stitched2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Stitched*>(obj1), static_cast<Box*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::stitched2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Stitched*>(obj1), static_cast<Poly*>(obj2), pCache);
+}
+
+CollisionInfo PhysicsScene::stitched2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache)
+{
+	return Collide(static_cast<Stitched*>(obj1), static_cast<Stitched*>(obj2), pCache);
+}
+
+void PhysicsScene::Restitution(float overlap, glm::vec2 const& collNormal, RigidBody * rb1, RigidBody * rb2)
+{
+	vec2 rb1Offset;
+	vec2 rb2Offset;
+	if (!RestitutionOffsets(overlap, collNormal, rb1, rb2, rb1Offset, rb2Offset))
+		return;
+
+	if (rb2)
+		rb2->setPosition(rb2->getPosition() - rb2Offset);
+	rb1->setPosition(rb1->getPosition() - rb1Offset);
+}
+
+bool PhysicsScene::RestitutionOffsets(float overlap, glm::vec2 const& collNormal, RigidBody* rb1, RigidBody* rb2, glm::vec2& rb1Offset, glm::vec2& rb2Offset)
+{
+	rb1Offset = { 0,0 };
+	rb2Offset = { 0,0 };
+	if (overlap <= 0.01f)
+		return false;
+
+	vec2 rb1Vel = rb1->getVelocity();
+
+	vec2 relVel = rb1Vel;
+
+	float ratio = 1;
+	if (rb2)
+	{
+		vec2 rb2Vel = rb2->getVelocity();
+
+		float rb1InvMass = 1 / rb1->getMass();
+		float rb2InvMass = 1 / rb2->getMass();
+
+		float rb1Mom = rb1InvMass * length(rb1Vel);
+		float rb2Mom = rb2InvMass * length(rb2Vel);
+
+		ratio = rb1Mom / (rb1Mom + rb2Mom);
+
+		relVel -= rb2Vel;
+
+		//float relSpeed = length(relVel);
+		float relSpeed = abs(dot(relVel, collNormal));
+
+		if (relSpeed > FLT_EPSILON)
+		{
+			float time = overlap / relSpeed;
+			rb1Offset = rb1Vel * time * ratio;
+			rb2Offset = rb2Vel * time * (1 - ratio);
+		}
+		else
+		{
+			rb1Offset = collNormal * overlap * ratio;
+			rb2Offset = -collNormal * overlap * (1 - ratio);
+		}
+	}
+	else
+	{
+		//float relSpeed = length(relVel);
+		float relSpeed = abs(dot(relVel, collNormal));
+
+		if (relSpeed > FLT_EPSILON)
+		{
+			float time = overlap / relSpeed;
+			rb1Offset = rb1Vel * time * ratio;
+		}
+		else
+		{
+			rb1Offset = -collNormal * overlap;
+		}
+	}
+
+	return true;
+}
+
+void PhysicsScene::debugScene()
+{
+	if (debugCount == 0)
+	{
+		system("CLS");
+		int count = 0;
+		for (auto pActor : m_actors) {
+			std::cout << count << " : ";
+			pActor->debug();
+			printf("\n");
+			count++;
+		}
+	}
+
+	debugCount++;
+	if (debugCount > DEBUG_FREQ)
+		debugCount = 0;
+}
+
+ShapeRef PhysicsScene::MakeShapeRef(PhysicsObject* actor)
+{
+	switch (actor->getShapeID())
+	{
+	case ShapeID::Plane:
+		return static_cast<Plane*>(actor);
+	case ShapeID::Sphere:
+		return static_cast<Sphere*>(actor);
+	case ShapeID::Box:
+		return static_cast<Box*>(actor);
+	case ShapeID::Poly:
+		return static_cast<Poly*>(actor);
+	default:
+		return static_cast<Stitched*>(actor);
+	}
+}
+
+bool PhysicsScene::ProjectionOverlap(float const & min1, float const & max1, float const & min2, float const & max2, float & overlap)
+{
+	if (max1 <= min2)	return false;
+	if (max2 <= min1)	return false;
+
+	// Overlap
+	float fMin = min(min1, min2);
+	float fMax = max(max1, max2);
+
+	overlap = fMax - fMin;
+	return true;
+}
+
+bool PhysicsScene::PolyAxisOverlap(Poly* poly1, Poly* poly2, vec2 const& axis, float & overlap)
+{
+	float poly1Max, poly1Min;
+	float poly2Max, poly2Min;
+
+	poly1->Project(axis, poly1Min, poly1Max);
+	poly2->Project(axis, poly2Min, poly2Max);
+
+	if (!ProjectionOverlap(poly1Min, poly1Max, poly2Min, poly2Max, overlap))
+		return false;
+
+	overlap -= (poly1Max - poly1Min);
+	overlap -= (poly2Max - poly2Min);
+
+	overlap = abs(overlap);
+	return true;
+}
+
+bool PhysicsScene::BoxPolyAxisOverlap(vec2 const* boxVerts, Poly* poly2, vec2 const& axis, float & overlap)
+{
+	float boxMax, boxMin;
+	float polyMax, polyMin;
+
+	boxMin = dot(axis, boxVerts[2]);
+	boxMax = boxMin;
+	for (int i = 0; i < 4; ++i)
+	{
+		float temp = dot(axis, boxVerts[i]);
+		if (temp < boxMin)
+		{
+			boxMin = temp;
+		}
+		else if (temp > boxMax)
+		{
+			boxMax = temp;
+		}
+	}
+
+	poly2->Project(axis, polyMin, polyMax);
+
+	if (!ProjectionOverlap(boxMin, boxMax, polyMin, polyMax, overlap))
+		return false;
+
+	overlap -= (polyMax - polyMin);
+	overlap -= (boxMax - boxMin);
+
+	overlap = abs(overlap);
+	return true;
+}
\ No newline at end of file
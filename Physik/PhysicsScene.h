@@ -1,79 +1,565 @@
-#pragma once
-
-#include <glm/ext.hpp>
-#include <vector>
-
-
-using std::vector;
-
-class PhysicsObject;
-class RigidBody;
-class Plane;
-
-struct CollisionInfo
-{
-	bool bCollision = false;
-	glm::vec2 collNormal;
-	float fPenetration;
-};
-
-class PhysicsScene
-{
-public:
-	PhysicsScene();
-	~PhysicsScene();
-	void AddActor(PhysicsObject* actor);
-	bool RemoveActor(PhysicsObject* actor);
-	void Update(float dt);
-	void UpdateGizmos();
-	void setGravity(const glm::vec2 gravity) { m_gravity = gravity; }
-	glm::vec2 getGravity() const { return m_gravity; }
-	void setTimeStep(const float timeStep) { m_timeStep = timeStep; }
-	float getTimeStep() const { return m_timeStep; };
-
-	void checkForCollision();
-
-
-	static CollisionInfo plane2Plane(PhysicsObject* obj1, PhysicsObject* obj2); 
-	static CollisionInfo plane2Sphere(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo plane2Box(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo plane2Poly(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo plane2Stitched(PhysicsObject* obj1, PhysicsObject* obj2);
-
-	static CollisionInfo sphere2Plane(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo sphere2Sphere(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo sphere2Box(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo sphere2Poly(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo sphere2Stitched(PhysicsObject* obj1, PhysicsObject* obj2);
-
-	static CollisionInfo box2Plane(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo box2Sphere(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo box2Box(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo box2Poly(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo box2Stitched(PhysicsObject* obj1, PhysicsObject* obj2);
-
-	static CollisionInfo poly2Plane(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo poly2Sphere(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo poly2Box(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo poly2Poly(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo poly2Stitched(PhysicsObject* obj1, PhysicsObject* obj2);
-
-	static CollisionInfo stitched2Plane(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo stitched2Sphere(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo stitched2Box(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo stitched2Poly(PhysicsObject* obj1, PhysicsObject* obj2);
-	static CollisionInfo stitched2Stitched(PhysicsObject* obj1, PhysicsObject* obj2);
-
-	void Restitution(float overlap, glm::vec2 const& collNormal, RigidBody* rb1, RigidBody* rb2 = nullptr);
-
-	void debugScene();
-protected:
-	static bool ProjectionOverlap(float const& min1, float const& max1, float const& min2, float const& max2, float & overlap);
-
-	glm::vec2 m_gravity;
-	float m_timeStep;
-	vector<PhysicsObject*> m_actors;
-
-	float time = 0;
-	int debugCount = 0;	
-};
+#pragma once
+
+#include <glm/ext.hpp>
+#include <vector>
+#include <variant>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "PairCache.h"
+#include "Broadphase.h"
+#include "RigidBody.h"
+#include "TaskGraph.h"
+#include "CommandQueue.h"
+#include "SceneQuery.h"
+
+
+using std::vector;
+
+class PhysicsObject;
+class Plane;
+class Sphere;
+class Box;
+class Poly;
+class Stitched;
+
+// Typed handle to an actor, the alternatives are in ShapeID order
+typedef std::variant<Plane*, Sphere*, Box*, Poly*, Stitched*> ShapeRef;
+
+struct CollisionInfo
+{
+	bool bCollision = false;
+	glm::vec2 collNormal = { 0,0 };
+	float fPenetration = 0;
+};
+
+// Per pair SAT state kept between steps. iAxis is the axis that separated the
+// pair last step, or the reference face if they were touching.
+struct SATCache
+{
+	int iAxis = -1;
+};
+
+// How a step resolves its contacts
+enum class ResolutionMode
+{
+	// island by island, each pair resolved as it is found. Stable stacking,
+	// but results depend on pair order within an island.
+	Sequential,
+	// every pair from the bodies as the pass began, summed per body and
+	// applied once. Order independent and parallel over all pairs, for big
+	// loosely coupled scenes.
+	Jacobi,
+};
+
+/***
+ * @brief What one Jacobi contact does to each of its bodies. Planes take
+ *			nothing.
+ */
+struct PairResolution
+{
+	glm::vec2 force1;
+	glm::vec2 force2;
+	// subtracted from each body's position to push the pair apart
+	glm::vec2 offset1;
+	glm::vec2 offset2;
+};
+
+// What Update does with time it could not step within its limits
+enum class StepOverflow
+{
+	// discard it, the scene skips ahead
+	Drop,
+	// carry up to one update's worth of steps forward, the scene runs slow
+	// until it catches up
+	Dilate,
+};
+
+struct StepStats
+{
+	// fixed steps run by the last Update
+	int steps = 0;
+	// wall clock seconds the last Update spent stepping
+	float fStepTime = 0;
+	// simulation time still owed after the last Update
+	float fDebt = 0;
+	// totals since the scene was made
+	float fDroppedTime = 0;
+	int overBudgetUpdates = 0;
+};
+
+/***
+ * @brief A pair of actors starting, staying in or leaving contact during a
+ *			step. Events are in order of step, then actor IDs.
+ */
+struct ContactEvent
+{
+	enum class Type : int
+	{
+		Begin = 0,
+		Persist,
+		End,
+	};
+
+	Type type;
+	// actor IDs, uActorA < uActorB. An End's actors may have been removed.
+	uint32_t uActorA;
+	uint32_t uActorB;
+	uint32_t uStep;
+	// as the narrowphase found it for A against B, zero for End and sensors
+	glm::vec2 normal;
+	float fPenetration;
+	// either actor is a sensor, Begin and End are it being entered and left
+	bool bSensor;
+};
+
+// A touching pair after a step, keyed by its actor IDs (low ID in the high word)
+struct ContactRecord
+{
+	uint64_t uKey;
+	glm::vec2 normal;
+	float fPenetration;
+	bool bSensor;
+};
+
+/***
+ * @brief One frame of the rollback ring, everything a step depends on
+ */
+struct SceneSnapshot
+{
+	// the scene's step count when saved
+	uint32_t uStep = 0;
+	bool bSaved = false;
+	float fAccumulatedTime = 0;
+	float fTime = 0;
+	uint64_t uStateHash = 0;
+	// indexed like the scene's actors, planes only keep their ID
+	vector<BodySnapshot> bodies;
+	vector<BodyState> prevStates;
+	vector<BodyState> currStates;
+	PairCache<SATCache>::Snapshot satCache;
+	vector<ContactRecord> contacts;
+};
+
+/***
+ * @brief A change to the scene queued from any thread, applied at the start
+ *			of the next fixed step
+ */
+struct SceneCommand
+{
+	// also the order commands on one actor with the same key are applied in
+	enum class Type : int
+	{
+		Add = 0,
+		Teleport,
+		Impulse,
+		Remove,
+	};
+
+	Type type;
+	// orders commands from different threads, lowest first
+	uint32_t uOrderKey;
+	// 0 for an Add, the actor is given its ID when the add is applied
+	uint32_t uActorID;
+	// Add only, the scene owns it once the command is queued
+	PhysicsObject* pActor;
+	// the impulse, or the position to teleport to
+	glm::vec2 vec;
+	float fRotation;
+	// set as the queue is drained, keeps one key's adds in the order queued
+	uint32_t uSequence;
+};
+
+class PhysicsScene
+{
+public:
+	PhysicsScene();
+	~PhysicsScene();
+	void AddActor(PhysicsObject* actor);
+	inline vector<PhysicsObject*> const& GetActors() const { return m_actors; };
+	// Finds an actor by the ID it was given when added, scene thread only
+	PhysicsObject* FindActor(uint32_t uActorID) const;
+
+	/***
+	 * @brief Thread safe. Queue changes to apply at the start of the next fixed
+	 *			step, so other threads never touch the scene while it steps.
+	 *
+	 * Commands are applied sorted by order key, then actor ID, then type, then
+	 *	their values, so the result does not depend on which thread queued
+	 *	first. Adds come first within a key, in the order they were queued, and
+	 *	take their IDs as they are applied. That order is only fixed if every
+	 *	thread queueing adds uses an order key no other thread uses. Each
+	 *	returns false if the queue is full.
+	 */
+	// The scene owns the actor once queued, GetID() is valid after the step
+	// that applies it. On failure the caller still owns it.
+	bool QueueAdd(PhysicsObject* actor, uint32_t uOrderKey);
+	// The actor is deleted once it has been removed
+	bool QueueRemove(uint32_t uActorID, uint32_t uOrderKey = 0);
+	bool QueueImpulse(uint32_t uActorID, glm::vec2 const& impulse, uint32_t uOrderKey = 0);
+	bool QueueTeleport(uint32_t uActorID, glm::vec2 const& position, float rotation, uint32_t uOrderKey = 0);
+	/***
+	 * @brief Sizes the storage a step works in, so Update does not allocate
+	 *			until the scene outgrows it. pairCount defaults to a few pairs
+	 *			per actor.
+	 */
+	void Reserve(int actorCount, int pairCount = -1);
+	bool RemoveActor(PhysicsObject* actor);
+	void Update(float dt);
+	void UpdateGizmos();
+
+	/***
+	 * @brief Runs Update(dt) on the scene's worker thread and returns at once.
+	 *			Until EndStep() returns, UpdateGizmos draws a snapshot taken
+	 *			here, and actors must not be added, removed or touched except
+	 *			through the queue. Actors removed by the queue are deleted at
+	 *			the next BeginStep, once the snapshot no longer holds them.
+	 */
+	void BeginStep(float dt);
+	// Waits for the step started by BeginStep, if there is one
+	void EndStep();
+	void setGravity(const glm::vec2 gravity) { m_gravity = gravity; }
+	glm::vec2 getGravity() const { return m_gravity; }
+	void setTimeStep(const float timeStep) { m_timeStep = timeStep; }
+	float getTimeStep() const { return m_timeStep; };
+
+	/***
+	 * @brief How far the accumulator is into the next fixed step, from 0 to 1.
+	 *			Rendering blends each body's previous and current step states
+	 *			by this so drawing stays smooth at any frame rate.
+	 */
+	inline float GetInterpolationAlpha() const { return glm::min(m_accumulatedTime / m_timeStep, 1.0f); };
+
+	// Most fixed steps one Update will run
+	inline void SetMaxStepsPerUpdate(int maxSteps) { m_maxStepsPerUpdate = maxSteps; };
+	inline int GetMaxStepsPerUpdate() const { return m_maxStepsPerUpdate; };
+	// Wall clock seconds one Update may spend stepping, 0 for no limit. At
+	// least one step always runs.
+	inline void SetStepBudget(float fSeconds) { m_fStepBudget = fSeconds; };
+	inline float GetStepBudget() const { return m_fStepBudget; };
+	inline void SetStepOverflow(StepOverflow overflow) { m_StepOverflow = overflow; };
+	inline StepOverflow GetStepOverflow() const { return m_StepOverflow; };
+	inline StepStats const& GetStepStats() const { return m_StepStats; };
+
+	// Runs one fixed step, Update calls this for each step it owes
+	void Step();
+	inline void SetResolutionMode(ResolutionMode mode) { m_ResolutionMode = mode; };
+	inline ResolutionMode GetResolutionMode() const { return m_ResolutionMode; };
+
+	/***
+	 * @brief Contact events from every step the last Update ran, found by
+	 *			diffing each step's touching pairs against the step before's.
+	 *			Update clears them before stepping, a bare Step appends.
+	 */
+	inline vector<ContactEvent> const& GetContactEvents() const { return m_ContactEvents; };
+	inline void ClearContactEvents() { m_ContactEvents.clear(); };
+	inline uint32_t GetStepCount() const { return m_uStepCount; };
+
+	/***
+	 * @brief Deterministic mode for lockstep and reproducible runs. Pairs are
+	 *			ordered by actor ID rather than actor index, the wall clock step
+	 *			budget is ignored, and a rolling hash of every body's state is
+	 *			updated after each step. The job system's thread count never
+	 *			changes results, in either mode.
+	 */
+	inline void SetDeterministic(bool bDeterministic) { m_bDeterministic = bDeterministic; };
+	inline bool GetDeterministic() const { return m_bDeterministic; };
+	// Rolling hash of the body states after every step so far, deterministic mode only
+	inline uint64_t GetStateHash() const { return m_uStateHash; };
+
+	/***
+	 * @brief Rollback for netcode. Keeps snapshots of the last frameCount
+	 *			saved steps in a ring sized here, so saving and restoring don't
+	 *			allocate while the actors stay the same.
+	 *
+	 * Restoring then stepping again reproduces the original steps exactly, as
+	 *	long as the same commands are queued for them. Neither may be called
+	 *	while an async step is running.
+	 */
+	void ReserveSnapshots(int frameCount);
+	// Saves the scene as of the current step count, over the oldest frame
+	void SaveSnapshot();
+	inline bool HasSnapshot(uint32_t uStep) const { return FindSnapshot(uStep) != nullptr; };
+	// False if the step has left the ring, or actors were added or removed since
+	bool RestoreSnapshot(uint32_t uStep);
+
+	/***
+	 * @brief Scene queries, through the broadphase tree then an exact test
+	 *			per shape. Directions don't need to be unit length, distances
+	 *			are along the normalised direction.
+	 *
+	 * Queries see bodies as they were at the end of the last step. Any number
+	 *	may run at once on different threads, but not while the scene steps.
+	 *	Until the next step after actors are added or removed, they fall back
+	 *	to testing every actor.
+	 */
+	// Closest hit along the ray, false if nothing is hit within fMaxDistance
+	bool Raycast(glm::vec2 const& origin, glm::vec2 const& direction, float fMaxDistance, RaycastHit& hit, uint32_t uLayerMask = 0xFFFFFFFF) const;
+	// Writes up to maxHits of the nearest hits, nearest first, and returns how many
+	int RaycastAll(glm::vec2 const& origin, glm::vec2 const& direction, float fMaxDistance, RaycastHit* hits, int maxHits, uint32_t uLayerMask = 0xFFFFFFFF) const;
+	/***
+	 * @brief Closest hit for each of count rays, hits[i].pActor is nullptr if
+	 *			ray i hits nothing. Rays go down the tree in packets of
+	 *			RayPacket::SIZE, and the packets are spread over the job system.
+	 */
+	void RaycastBatch(RayQuery const* rays, RaycastHit* hits, int count) const;
+	// Each writes up to maxResults overlapping actors and returns how many
+	int OverlapPoint(glm::vec2 const& point, PhysicsObject** results, int maxResults) const;
+	int OverlapAABB(Bounds const& bounds, PhysicsObject** results, int maxResults) const;
+	int OverlapCircle(glm::vec2 const& center, float radius, PhysicsObject** results, int maxResults) const;
+	/***
+	 * @brief Earliest hit sweeping a shape along a displacement, without
+	 *			rotating it. The shape may be one of the scene's actors, it
+	 *			never hits itself. Its bounds must be current.
+	 */
+	bool ShapeCast(Sphere* sphere, glm::vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask = 0xFFFFFFFF) const;
+	bool ShapeCast(Box* box, glm::vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask = 0xFFFFFFFF) const;
+	bool ShapeCast(Poly* poly, glm::vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask = 0xFFFFFFFF) const;
+
+	// Jobs the step's task graph runs on, aie::JobSystem::getDefault() unless set
+	inline void SetJobSystem(aie::JobSystem* pJobs) { m_pJobs = pJobs; };
+	inline aie::JobSystem* GetJobSystem() const { return m_pJobs; };
+	inline TaskGraph const& GetStepGraph() const { return m_StepGraph; };
+
+	void checkForCollision();
+	void FindCollisionPairs();
+
+
+	// Typed narrowphase tests, the named tests below forward to these
+	static CollisionInfo Collide(Plane* plane1, Plane* plane2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Plane* plane1, Sphere* sphere2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Plane* plane1, Box* box2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Plane* plane1, Poly* poly2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Plane* plane1, Stitched* stitched1, SATCache* pCache = nullptr);
+
+	static CollisionInfo Collide(Sphere* sphere1, Plane* plane2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Sphere* sphere1, Sphere* sphere2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Sphere* sphere1, Box* box2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Sphere* sphere1, Poly* poly2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Sphere* sphere1, Stitched* stitched1, SATCache* pCache = nullptr);
+
+	static CollisionInfo Collide(Box* box1, Plane* plane2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Box* box1, Sphere* sphere2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Box* box1, Box* box2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Box* box1, Poly* poly2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Box* box1, Stitched* stitched1, SATCache* pCache = nullptr);
+
+	static CollisionInfo Collide(Poly* poly1, Plane* plane2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Poly* poly1, Sphere* sphere2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Poly* poly1, Box* box2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Poly* poly1, Poly* poly2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Poly* poly1, Stitched* stitched1, SATCache* pCache = nullptr);
+
+	static CollisionInfo Collide(Stitched* stitched1, Plane* plane2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Stitched* stitched1, Sphere* sphere2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Stitched* stitched1, Box* box2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Stitched* stitched1, Poly* poly2, SATCache* pCache = nullptr);
+	static CollisionInfo Collide(Stitched* stitched1, Stitched* stitched2, SATCache* pCache = nullptr);
+
+	static CollisionInfo plane2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr); 
+	static CollisionInfo plane2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo plane2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo plane2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo plane2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+
+	static CollisionInfo sphere2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo sphere2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo sphere2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo sphere2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo sphere2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+
+	static CollisionInfo box2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo box2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo box2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo box2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo box2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+
+	static CollisionInfo poly2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo poly2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo poly2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo poly2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo poly2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+
+	static CollisionInfo stitched2Plane(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo stitched2Sphere(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo stitched2Box(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo stitched2Poly(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+	static CollisionInfo stitched2Stitched(PhysicsObject* obj1, PhysicsObject* obj2, SATCache* pCache = nullptr);
+
+	void Restitution(float overlap, glm::vec2 const& collNormal, RigidBody* rb1, RigidBody* rb2 = nullptr);
+	// How far Restitution would move each body, false if it wouldn't
+	static bool RestitutionOffsets(float overlap, glm::vec2 const& collNormal, RigidBody* rb1, RigidBody* rb2, glm::vec2& rb1Offset, glm::vec2& rb2Offset);
+
+	void Resolve(CollisionInfo const& info, Plane* plane1, RigidBody* rb2);
+	void Resolve(CollisionInfo const& info, RigidBody* rb1, Plane* plane2);
+	void Resolve(CollisionInfo const& info, RigidBody* rb1, RigidBody* rb2);
+	inline void Resolve(CollisionInfo const& info, Plane* plane1, Plane* plane2) {};
+
+	// What Resolve would do to each body, without doing it
+	static void ComputeResolution(CollisionInfo const& info, Plane* plane1, RigidBody* rb2, PairResolution& resolution);
+	static void ComputeResolution(CollisionInfo const& info, RigidBody* rb1, Plane* plane2, PairResolution& resolution);
+	static void ComputeResolution(CollisionInfo const& info, RigidBody* rb1, RigidBody* rb2, PairResolution& resolution);
+	static inline void ComputeResolution(CollisionInfo const& info, Plane* plane1, Plane* plane2, PairResolution& resolution) {};
+
+	void debugScene();
+protected:
+	// Double buffers every body's state at the end of a step
+	void CaptureStates(int begin, int end);
+	// Drains the command queue and applies it in its sorted order
+	void ApplyCommands();
+	// Folds every body's state into m_uStateHash
+	void HashStates();
+	// Sorts this step's touching pairs and diffs them against last step's into m_ContactEvents
+	void BuildContactEvents();
+	SceneSnapshot const* FindSnapshot(uint32_t uStep) const;
+	/***
+	 * @brief Declares one fixed step as tasks: integrate, bounds, broadphase,
+	 *			islands, solve (one chunk per island, or the Jacobi pairs then
+	 *			bodies), sensors, then capture and contacts, then refit and hash
+	 */
+	void BuildStepGraph();
+	/***
+	 * @brief Splits the pairs into islands of bodies that touch, so no two
+	 *			islands write the same body and they can be solved in parallel
+	 */
+	void BuildIslands();
+	int FindIsland(int actor);
+	// Looks up each pair's SAT cache before the pairs are solved in parallel
+	void FindPairCaches();
+	// Jacobi mode's stand in for BuildIslands, lists each body's pairs
+	void BuildBodyPairs();
+	// Tests a pair and works out its resolution from the bodies as they were before the pass
+	void SolveJacobiPair(int pair);
+	// Sums an actor's Jacobi contacts and applies them to it
+	void ApplyJacobi(int actor);
+	inline bool IsSensorPair(int pair) const { return m_actors[m_Pairs[pair].a]->IsSensor() || m_actors[m_Pairs[pair].b]->IsSensor(); };
+	// Tests and resolves an island's pairs in sorted order
+	void SolveIsland(int island);
+	// Tests whether a sensor pair overlaps, resolving nothing
+	void TestSensorPair(int pair);
+	// A sensor only needs to know if a pair touches, not how deep or which way
+	template <class A, class B>
+	static bool SensorOverlap(A* pShape1, B* pShape2);
+	void DrawStates(vector<PhysicsObject*> const& actors, vector<BodyState> const& prevStates, vector<BodyState> const& currStates, float alpha);
+	// Deletes actors removed by queued commands, once no snapshot can draw them
+	void DeleteRemovedActors();
+	void StepWorker();
+
+	/***
+	 * @brief Calls func(actorIndex) for every actor whose bounds overlap a
+	 *			box, and every plane
+	 */
+	template <class F>
+	void ForEachQueryCandidate(Bounds const& bounds, F&& func) const;
+	// As above along a ray, func returns the distance to keep searching to
+	template <class F>
+	void ForEachRayCandidate(glm::vec2 const& origin, glm::vec2 const& direction, float fMaxDistance, F&& func) const;
+
+	template <class S>
+	bool ShapeCastShape(S* shape, glm::vec2 const& displacement, ShapeCastHit& hit, uint32_t uLayerMask) const;
+
+	// Closest hits for up to RayPacket::SIZE rays, traversing the tree once
+	void RaycastPacket(RayQuery const* rays, RaycastHit* hits, int count) const;
+	static const int PACKET_GRAIN = 16;
+
+	static ShapeRef MakeShapeRef(PhysicsObject* actor);
+	static bool ProjectionOverlap(float const& min1, float const& max1, float const& min2, float const& max2, float & overlap);
+	static bool PolyAxisOverlap(Poly* poly1, Poly* poly2, glm::vec2 const& axis, float & overlap);
+	static bool BoxPolyAxisOverlap(glm::vec2 const* boxVerts, Poly* poly2, glm::vec2 const& axis, float & overlap);
+
+	glm::vec2 m_gravity;
+	float m_timeStep;
+	// time not yet simulated, less than one step after Update returns
+	float m_accumulatedTime = 0;
+
+	uint32_t m_uStepCount = 0;
+	bool m_bDeterministic = false;
+	// FNV-1a, starting from its offset basis
+	uint64_t m_uStateHash = 14695981039346656037ull;
+
+	int m_maxStepsPerUpdate = 8;
+	float m_fStepBudget = 0;
+	StepOverflow m_StepOverflow = StepOverflow::Drop;
+	StepStats m_StepStats;
+	vector<PhysicsObject*> m_actors;
+	// same order as m_actors
+	vector<ShapeRef> m_shapes;
+	// index into m_actors by actor ID, -1 once removed
+	vector<int> m_ActorIndexByID;
+	uint32_t m_nextActorID = 1;
+
+	CommandQueue<SceneCommand> m_CommandQueue;
+	// drained commands, sized to the queue so applying never allocates
+	vector<SceneCommand> m_Commands;
+	// rollback ring, a step is kept in slot uStep % size
+	vector<SceneSnapshot> m_Snapshots;
+	// body states after the last two steps, indexed like m_actors
+	vector<BodyState> m_prevStates;
+	vector<BodyState> m_currStates;
+
+	// Copied when an async step begins, what rendering reads meanwhile
+	vector<PhysicsObject*> m_renderActors;
+	vector<BodyState> m_renderPrevStates;
+	vector<BodyState> m_renderCurrStates;
+	float m_fRenderAlpha = 0;
+	bool m_bAsync = false;
+	// removed by queued commands while the render snapshot may still hold them
+	vector<PhysicsObject*> m_RemovedActors;
+
+	std::thread m_StepThread;
+	std::mutex m_StepMutex;
+	std::condition_variable m_StepCondition;
+	float m_fPendingDt = 0;
+	bool m_bStepPending = false;
+	bool m_bStopWorker = false;
+	PairCache<SATCache> m_SATCache;
+	Broadphase m_Broadphase;
+	// set when actors change between steps, the tree's indices are out of date
+	bool m_bQueryTreeStale = true;
+	vector<BroadphasePair> m_Pairs;
+
+	// union-find parents, by actor
+	vector<int> m_IslandParent;
+	vector<int> m_IslandOfRoot;
+	// by pair
+	vector<int> m_PairIsland;
+	vector<SATCache*> m_PairCaches;
+	// each pair's narrowphase result, written by its island's solve or the sensor test
+	vector<CollisionInfo> m_PairContacts;
+	// island i's pair indices are m_IslandPairs[m_IslandStart[i], m_IslandStart[i + 1])
+	vector<int> m_IslandStart;
+	vector<int> m_IslandPairs;
+	int m_islandCount = 0;
+	// pairs with a sensor in them, in no island
+	vector<int> m_SensorPairs;
+
+	ResolutionMode m_ResolutionMode = ResolutionMode::Sequential;
+	// Jacobi only, by pair
+	vector<PairResolution> m_PairResolutions;
+	// Jacobi only, actor i's pairs are m_BodyPairs[m_BodyPairStart[i], m_BodyPairStart[i + 1])
+	vector<int> m_BodyPairStart;
+	vector<int> m_BodyPairs;
+
+	// touching pairs after the last step sorted by key, and the next step's being built
+	vector<ContactRecord> m_Contacts;
+	vector<ContactRecord> m_NextContacts;
+	vector<ContactEvent> m_ContactEvents;
+
+	static const int ACTOR_GRAIN = 64;
+	static const int SENSOR_GRAIN = 64;
+	static const int PAIR_GRAIN = 64;
+	TaskGraph m_StepGraph;
+	aie::JobSystem* m_pJobs;
+
+	float time = 0;
+	int debugCount = 0;	
+
+	static const int PAIRS_PER_ACTOR = 4;
+	int m_reservedActors = 0;
+
+#ifdef PHYSIK_ALLOC_GUARD
+	int m_guardedUpdates = 0;
+	// counts this scene's steps only, on whichever threads run them
+	AllocGuard m_AllocGuard;
+#endif
+};
@@ -1,42 +1,55 @@
-#include "Plane.h"
-#include <Gizmos.h>
-
-using aie::Gizmos;
-
-Plane::Plane(vec2 normal, float distance, float fFricCoStatic, float fFricCoDynamic) : PhysicsObject::PhysicsObject(ShapeID::Plane, fFricCoStatic, fFricCoDynamic)
-{
-	m_normal = normalize(normal);
-	m_distanceToOrigin = distance;
-}
-
-
-Plane::~Plane()
-{
-}
-
-void Plane::makeGizmo()
-{
-	float lineSegmentLength = 300;
-	vec2 centerPoint = m_normal * m_distanceToOrigin;
-	vec2 parallel(m_normal.y, -m_normal.x);
-	vec4 colour(1, 1, 1, 1);
-	vec2 start = centerPoint + (parallel * lineSegmentLength);
-	vec2 end = centerPoint - (parallel * lineSegmentLength);
-
-	Gizmos::add2DLine(start, end, colour);
-}
-
-void Plane::resetPosition()
-{
-}
-
-void Plane::resolveCollision(RigidBody * actor2, vec2 const & normal)
-{
-
-	float j = dot(-(1 + actor2->getElasticity()) * actor2->getVelocity(), normal) /
-		dot(normal, normal * (1 / actor2->getMass()));
-
-	vec2 force = normal * j;
-
-	actor2->applyForce(force);
-}
+#include "Plane.h"
+#include <Gizmos.h>
+
+using aie::Gizmos;
+
+Plane::Plane(vec2 normal, float distance, float fFricCoStatic, float fFricCoDynamic) : PhysicsObject::PhysicsObject(ShapeID::Plane, fFricCoStatic, fFricCoDynamic)
+{
+	m_normal = normalize(normal);
+	m_distanceToOrigin = distance;
+}
+
+
+Plane::~Plane()
+{
+}
+
+void Plane::makeGizmo()
+{
+	float lineSegmentLength = 300;
+	vec2 centerPoint = m_normal * m_distanceToOrigin;
+	vec2 parallel(m_normal.y, -m_normal.x);
+	vec4 colour(1, 1, 1, 1);
+	vec2 start = centerPoint + (parallel * lineSegmentLength);
+	vec2 end = centerPoint - (parallel * lineSegmentLength);
+
+	Gizmos::add2DLine(start, end, colour);
+}
+
+void Plane::resetPosition()
+{
+}
+
+void Plane::resolveCollision(RigidBody * actor2, vec2 const & normal)
+{
+	actor2->applyForce(ResolutionForce(actor2, normal));
+}
+
+vec2 Plane::ResolutionForce(RigidBody const* actor2, vec2 const& normal) const
+{
+	float j = dot(-(1 + actor2->getElasticity()) * actor2->getVelocity(), normal) /
+		dot(normal, normal * (1 / actor2->getMass()));
+
+	return normal * j;
+}
+
+bool Plane::OverlapsBounds(Bounds const & bounds) const
+{
+	vec2 center = (bounds.min + bounds.max) * 0.5f;
+	vec2 extents = (bounds.max - bounds.min) * 0.5f;
+
+	float r = (extents.x * abs(m_normal.x)) + (extents.y * abs(m_normal.y));
+	float s = dot(m_normal, center) - m_distanceToOrigin;
+
+	return abs(s) <= r;
+}
\ No newline at end of file
@@ -1,212 +1,179 @@
-#include "Poly.h"
-#include <Gizmos.h>
-
-#define DEBUG true
-#define SHOW_NORMALS true
-
-Poly::Poly(vector<vec2> const & vertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour) :
-	RigidBody::RigidBody(ShapeID::Poly, position, velocity, rotation, fAngVel, mass, elasticity, fFricCoStatic, fFricCoDynamic, fDrag, fAngDrag)
-{
-	m_Colour = colour;
-	m_Vertices = vertices;
-
-	Transform pos = Transform();
-	pos.SetPosition(position);
-
-	Transform rot = Transform();
-	rot.SetRotate2D(rotation);
-
-	m_GlobalTransform.LocalTransform(pos.GetTransform(), rot.GetTransform(), Transform::Identity());
-
-	CreateSNorms();
-	CreateBroadColl();
-}
-
-Poly::~Poly()
-{
-	delete m_pBroadColl;
-}
-
-void Poly::fixedUpdate(vec2 const& gravity, float timeStep)
-{
-	RigidBody::fixedUpdate(gravity, timeStep);
-
-	m_pBroadColl->setPosition(m_position);
-
-	Transform pos = Transform();
-	pos.SetPosition(m_position);
-
-	Transform rot = Transform();
-	rot.SetRotate2D(m_rotation);
-
-	m_GlobalTransform.LocalTransform(pos.GetTransform(), rot.GetTransform(), Transform::Identity());
-}
-
-
-void Poly::makeGizmo()
-{
-	if (DEBUG)
-		m_pBroadColl->makeGizmo();
-
-	vec2 start;
-	vec2 end;
-	uint count = m_Vertices.size();
-	for (uint i = 0; i < count; ++i)
-	{
-		uint j = i + 1;
-		if (j >= count)
-			j = 0;
-
-		start = GetRotatedVert(i) + m_position;
-		end = GetRotatedVert(j) + m_position;
-		if (m_bIsFilled)
-			aie::Gizmos::add2DTri(start, m_position, end, m_Colour);
-		else
-			aie::Gizmos::add2DLine(start, end, m_Colour);
-	}
-
-	if (SHOW_NORMALS)
-	{
-		uint normalCount = m_SNorms.size();
-		for (uint i = 0; i < normalCount; ++i)
-		{
-			uint j = i + 1;
-			if (j >= count)
-				j = 0;
-
-			start = GetRotatedVert(i);
-			end = GetRotatedVert(j);
-
-			vec2 mid = ((start + end) * 0.5f) + m_position;
-			vec2 norm = GetRotatedSNorm(i);
-
-			aie::Gizmos::add2DLine(mid, norm + mid, {1, 0, 0, 1});
-		}
-	}
-}
-
-void Poly::Move(Transform const& parentTransform, Transform const& localTransform)
-{
-	m_GlobalTransform.GlobalTransform(parentTransform.GetTransform(), localTransform.GetTransform());
-	m_position = m_GlobalTransform.GetPosition();
-	m_pBroadColl->setPosition(m_position);
-}
-
-vec2 Poly::GetRotatedVert(int index) const
-{
-	if (index >= m_Vertices.size())
-		assert(!"m_Vertices index OUT OF BOUNDS");
-
-	mat3 temp = m_GlobalTransform.GetTransform();
-
-	mat2 rotMat;
-	rotMat[0][0] = temp[0][0];
-	rotMat[0][1] = temp[0][1];
-	rotMat[1][0] = temp[1][0];
-	rotMat[1][1] = temp[1][1];
-
-	vec2 result = rotMat * m_Vertices[index];
-
-	return result;
-}
-
-vec2 Poly::GetRotatedSNorm(int index) const
-{
-	if (index >= m_SNorms.size())
-		assert(!"m_SNorms index OUT OF BOUNDS");
-
-	mat3 temp = m_GlobalTransform.GetTransform();
-
-	mat2 rotMat;
-	rotMat[0][0] = temp[0][0];
-	rotMat[0][1] = temp[0][1];
-	rotMat[1][0] = temp[1][0];
-	rotMat[1][1] = temp[1][1];
-
-	vec2 result = rotMat * m_SNorms[index].norm;
-
-	return result;
-}
-
-void Poly::Project(vec2 const & axis, float & min, float & max)
-{
-	min = dot(axis, GetRotatedVert(0) + m_position);
-	max = min;
-
-	for (int i = 1; i < GetVerticeCount(); ++i)
-	{
-		float temp = dot(axis, GetRotatedVert(i) + m_position);
-		if (temp < min)
-		{
-			min = temp;
-		}
-		else if (temp > max)
-		{
-			max = temp;
-		}
-	}
-}
-
-void Poly::CreateBroadColl()
-{
-	float radius = 0;
-	for each (vec2 vert in m_Vertices)
-	{
-		float temp = length(vert);
-		if (radius < temp)
-			radius = temp;
-	}
-	radius += 0.1f;
-	
-	if (m_pBroadColl)
-		delete m_pBroadColl;
-	
-	vec4 colour = { 1,1,1,1 };
-	colour -= m_Colour;
-	colour.a = 0.5f;
-
-	m_pBroadColl = new Sphere(m_position, { 0,0 }, 0, m_mass, m_elasticity, 1.0f, 1.0f, 0, 0, radius, colour);
-	m_pBroadColl->HideDirLine();
-}
-
-void Poly::CreateSNorms()
-{
-	m_SNorms.clear();
-
-	for (int i = 0; i < GetVerticeCount(); ++i)
-	{
-		int j = i + 1;
-		if (j >= GetVerticeCount())
-			j = 0;
-
-		vec2 vec = m_Vertices[i] - m_Vertices[j];
-
-		vec2 norm;
-		norm.x = vec.y;
-		norm.y = -vec.x;
-
-		norm = normalize(norm);
-
-		SurfaceNorm sNorm;
-		sNorm.norm = norm;
-
-		m_SNorms.push_back(sNorm);
-	}
-
-	// Parallel check
-	for (int i = 0; i < (m_SNorms.size() - 1); ++i)
-	{
-		for (int j = i + 1; j < m_SNorms.size(); ++j)
-		{
-			vec2 lhs = m_SNorms[i].norm;
-			vec2 rhs = m_SNorms[j].norm;
-
-			float check = dot(lhs, rhs);
-
-			if (abs(check) >= 1 - FLT_EPSILON)
-			{
-				m_SNorms[j].hasParallel = true;
-			}
-		}
-	}
-}
+#include "Poly.h"
+#include <Gizmos.h>
+
+#define DEBUG true
+#define SHOW_NORMALS true
+
+Poly::Poly(vector<vec2> const & vertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour) :
+	Poly(GeometryRegistry::GetPoly(vertices), position, velocity, rotation, fAngVel, mass, elasticity, fFricCoStatic, fFricCoDynamic, fDrag, fAngDrag, colour)
+{
+}
+
+Poly::Poly(shared_ptr<const PolyGeometry> const& pGeometry, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour) :
+	RigidBody::RigidBody(ShapeID::Poly, position, velocity, rotation, fAngVel, mass, elasticity, fFricCoStatic, fFricCoDynamic, fDrag, fAngDrag)
+{
+	m_Colour = colour;
+	m_pGeometry = pGeometry;
+
+	m_GlobalTransform.Set(position, rotation);
+
+	UpdateBounds();
+}
+
+Poly::~Poly()
+{
+}
+
+void Poly::fixedUpdate(vec2 const& gravity, float timeStep)
+{
+	RigidBody::fixedUpdate(gravity, timeStep);
+
+	m_GlobalTransform.Set(m_position, m_rotation);
+}
+
+
+void Poly::DrawGizmo(BodyState const& state) const
+{
+	DrawAt(Transform(state.position, state.rotation), state.bIsFilled);
+}
+
+void Poly::DrawAt(Transform const& transform, bool bIsFilled) const
+{
+	vector<vec2> const& vertices = m_pGeometry->vertices;
+	vec2 position = transform.GetPosition();
+
+	if (DEBUG)
+	{
+		vec4 colour = { 1,1,1,1 };
+		colour -= m_Colour;
+		colour.a = 0.5f;
+
+		aie::Gizmos::add2DCircle(transform.TransformPoint(m_pGeometry->centroid), GetBoundRadius(), 69U, colour);
+	}
+
+	vec2 start;
+	vec2 end;
+	uint count = GetVerticeCount();
+	for (uint i = 0; i < count; ++i)
+	{
+		uint j = i + 1;
+		if (j >= count)
+			j = 0;
+
+		start = transform.TransformPoint(vertices[i]);
+		end = transform.TransformPoint(vertices[j]);
+		if (bIsFilled)
+			aie::Gizmos::add2DTri(start, position, end, m_Colour);
+		else
+			aie::Gizmos::add2DLine(start, end, m_Colour);
+	}
+
+	if (SHOW_NORMALS)
+	{
+		uint normalCount = GetSNormCount();
+		for (uint i = 0; i < normalCount; ++i)
+		{
+			uint j = i + 1;
+			if (j >= count)
+				j = 0;
+
+			start = transform.Rotate(vertices[i]);
+			end = transform.Rotate(vertices[j]);
+
+			vec2 mid = ((start + end) * 0.5f) + position;
+			vec2 norm = transform.Rotate(m_pGeometry->sNorms[i].norm);
+
+			aie::Gizmos::add2DLine(mid, norm + mid, {1, 0, 0, 1});
+		}
+	}
+}
+
+void Poly::Move(Transform const& parentTransform, Transform const& localTransform)
+{
+	m_GlobalTransform.GlobalTransform(parentTransform, localTransform);
+	m_position = m_GlobalTransform.GetPosition();
+}
+
+void Poly::SetPose(vec2 const& position, float rotation)
+{
+	m_position = position;
+	m_rotation = rotation;
+	m_GlobalTransform.Set(m_position, m_rotation);
+
+	UpdateBounds();
+}
+
+void Poly::SaveSnapshot(BodySnapshot& snapshot) const
+{
+	RigidBody::SaveSnapshot(snapshot);
+	snapshot.transform = m_GlobalTransform;
+}
+
+void Poly::LoadSnapshot(BodySnapshot const& snapshot)
+{
+	RigidBody::LoadSnapshot(snapshot);
+	m_GlobalTransform = snapshot.transform;
+	m_BoundCenter = m_GlobalTransform.TransformPoint(m_pGeometry->centroid);
+}
+
+void Poly::UpdateBounds()
+{
+	// Rotate the cooked local box rather than every vertex, and clip it to
+	// the bounding circle since either one alone can be loose
+	vec2 localCenter = (m_pGeometry->boundsMin + m_pGeometry->boundsMax) * 0.5f;
+	vec2 localExtents = (m_pGeometry->boundsMax - m_pGeometry->boundsMin) * 0.5f;
+
+	float c = abs(m_GlobalTransform.GetCos());
+	float s = abs(m_GlobalTransform.GetSin());
+	vec2 extents = { c * localExtents.x + s * localExtents.y, s * localExtents.x + c * localExtents.y };
+	vec2 center = m_position + m_GlobalTransform.Rotate(localCenter);
+
+	m_BoundCenter = m_position + m_GlobalTransform.Rotate(m_pGeometry->centroid);
+	float radius = GetBoundRadius();
+
+	m_Bounds.min = max(center - extents, m_BoundCenter - vec2(radius));
+	m_Bounds.max = min(center + extents, m_BoundCenter + vec2(radius));
+}
+
+vec2 Poly::GetRotatedVert(int index) const
+{
+	if (index >= GetVerticeCount())
+		assert(!"vertices index OUT OF BOUNDS");
+
+	return m_GlobalTransform.Rotate(m_pGeometry->vertices[index]);
+}
+
+vec2 Poly::GetRotatedSNorm(int index) const
+{
+	if (index >= GetSNormCount())
+		assert(!"sNorms index OUT OF BOUNDS");
+
+	return m_GlobalTransform.Rotate(m_pGeometry->sNorms[index].norm);
+}
+
+void Poly::Project(vec2 const & axis, float & min, float & max)
+{
+	// Bring the axis into local space once rather than rotating every vertex
+	vec2 localAxis = m_GlobalTransform.InvRotate(axis);
+	float offset = dot(axis, m_position);
+
+	vector<vec2> const& vertices = m_pGeometry->vertices;
+	min = dot(localAxis, vertices[0]);
+	max = min;
+
+	for (int i = 1; i < (int)vertices.size(); ++i)
+	{
+		float temp = dot(localAxis, vertices[i]);
+		if (temp < min)
+		{
+			min = temp;
+		}
+		else if (temp > max)
+		{
+			max = temp;
+		}
+	}
+
+	min += offset;
+	max += offset;
+}
\ No newline at end of file
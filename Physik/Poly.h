@@ -1,55 +1,56 @@
-#pragma once
-#include "RigidBody.h"
-#include"Sphere.h"
-#include <glm/ext.hpp>
-#include <vector>
-#include "Transform.h"
-
-using namespace glm;
-using std::vector;
-
-struct SurfaceNorm
-{
-	vec2 norm = {0,0};
-	bool hasParallel = false;
-};
-
-class Poly : public RigidBody
-{
-public:
-	Poly(vector<vec2> const& vertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour);
-	~Poly();
-
-	inline void SetRotation(float rotation) { m_rotation = rotation; };
-
-	inline vector<vec2> GetVerts() const { return m_Vertices; }
-	inline void SetVerts(vector<vec2> const& vertices) { m_Vertices = vertices; CreateBroadColl(); CreateSNorms(); };
-	inline int GetVerticeCount() const { return (int)m_Vertices.size(); };
-	inline int GetSNormCount() const { return (int)m_SNorms.size(); };
-	inline bool GetSNormParallel(int index) const { return m_SNorms[index].hasParallel; }
-
-	inline Sphere* GetBroadColl() const { return m_pBroadColl; };
-
-	void fixedUpdate(vec2 const& gravity, float timeStep);
-	void makeGizmo();
-	void Move(Transform const& parentTransform, Transform const& localTransform);
-
-	vec2 GetRotatedVert(int index) const;
-	vec2 GetRotatedSNorm(int index) const;
-
-	void Project(vec2 const& axis, float & min, float & max);
-
-	bool checkCollision(PhysicsObject* pOther) { return false; };
-
-private:
-	void CreateBroadColl();
-	void CreateSNorms();
-
-	Transform m_GlobalTransform;
-
-	vec4 m_Colour;
-	vector<SurfaceNorm> m_SNorms;
-	vector<vec2> m_Vertices;
-	Sphere* m_pBroadColl = nullptr;
-};
-
+#pragma once
+#include "RigidBody.h"
+#include <glm/ext.hpp>
+#include <vector>
+#include "Transform.h"
+#include "ShapeGeometry.h"
+
+using namespace glm;
+using std::vector;
+
+class Poly : public RigidBody
+{
+public:
+	Poly(vector<vec2> const& vertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour);
+	Poly(shared_ptr<const PolyGeometry> const& pGeometry, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour);
+	~Poly();
+
+	inline void SetRotation(float rotation) { m_rotation = rotation; };
+
+	inline vector<vec2> const& GetVerts() const { return m_pGeometry->vertices; }
+	inline void SetVerts(vector<vec2> const& vertices) { m_pGeometry = GeometryRegistry::GetPoly(vertices); UpdateBounds(); };
+	inline shared_ptr<const PolyGeometry> const& GetGeometry() const { return m_pGeometry; };
+	inline vec4 GetColour() const { return m_Colour; };
+	inline int GetVerticeCount() const { return (int)m_pGeometry->vertices.size(); };
+	inline int GetSNormCount() const { return (int)m_pGeometry->sNorms.size(); };
+	inline bool GetSNormParallel(int index) const { return m_pGeometry->sNorms[index].hasParallel; }
+
+	// bounding circle about the hull's centroid
+	inline vec2 GetBoundCenter() const { return m_BoundCenter; };
+	inline float GetBoundRadius() const { return m_pGeometry->fCentroidRadius; };
+
+	void fixedUpdate(vec2 const& gravity, float timeStep);
+	void DrawGizmo(BodyState const& state) const;
+	// Draws the hull placed by a transform rather than the body's own pose
+	void DrawAt(Transform const& transform, bool bIsFilled) const;
+	void Move(Transform const& parentTransform, Transform const& localTransform);
+	void SetPose(vec2 const& position, float rotation);
+	void SaveSnapshot(BodySnapshot& snapshot) const;
+	void LoadSnapshot(BodySnapshot const& snapshot);
+	void UpdateBounds();
+
+	vec2 GetRotatedVert(int index) const;
+	vec2 GetRotatedSNorm(int index) const;
+
+	void Project(vec2 const& axis, float & min, float & max);
+
+	bool checkCollision(PhysicsObject* pOther) { return false; };
+
+private:
+	Transform m_GlobalTransform;
+
+	vec4 m_Colour;
+	shared_ptr<const PolyGeometry> m_pGeometry;
+	vec2 m_BoundCenter;
+};
+
@@ -1,58 +1,114 @@
-#pragma once
-#include "PhysicsObject.h"
-class RigidBody : public PhysicsObject {
-public:
-	RigidBody(ShapeID shapeID, glm::vec2 position, glm::vec2 velocity, float rotation, float fAngVelocity, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag);
-	virtual ~RigidBody();
-
-	virtual void fixedUpdate(glm::vec2 const& gravity, float timeStep);
-	virtual void debug();
-
-	void applyForce(glm::vec2 const& force);
-	void applyForceToActor(RigidBody* actor2, glm::vec2 const& force);
-
-	//virtual bool checkCollision(PhysicsObject* pOther) = 0;
-
-	inline void AddResolutionForce(glm::vec2 const& force) { m_ResolutionForceSum += force; };
-	inline void AddResolutionForceToActor(RigidBody* actor2, glm::vec2 const& force) { AddResolutionForce(force); actor2->AddResolutionForce(-force); }
-	inline void ApplyResolutionForce() { applyForce(m_ResolutionForceSum); m_ResolutionForceSum = { 0,0 }; };
-
-	inline void setPosition(glm::vec2 const& pos) { m_position = pos; }
-	inline glm::vec2 getPosition() const { return m_position; }
-	inline void setRotation(float const& rot) { m_rotation = rot; };
-	inline float getRotation() const { return m_rotation; }
-	inline void setVelocity(glm::vec2 const& velocity) { m_velocity = velocity; };
-	inline glm::vec2 getVelocity() const { return m_velocity; }
-	inline float getMass() const { return m_mass; }
-	inline float getElasticity() const { return m_elasticity; };
-	inline void setAngularVelocity(float const& angVel) { m_angularVelocity = angVel; };
-	inline float getAngularVelocity() const { return m_angularVelocity; };
-	inline void setAngularDrag(float const& angDrag) { m_angularDrag = angDrag; };
-	inline float getAngularDrag() const { return m_angularDrag; };
-	inline void setDrag(float const& drag) { m_drag = drag; };
-	inline float getDrag() const { return m_drag; };
-
-	inline bool GetIsFilled() const { return m_bIsFilled; };
-	inline void SetIsFilled(bool const& bIsFilled) { m_bIsFilled = bIsFilled; };
-	inline void InvertIsFilled() { m_bIsFilled = !m_bIsFilled; };
-	
-	void resolveCollision(RigidBody* actor2, glm::vec2 const& normal);
-protected:
-	void ApplyDrags(float const& timeStep);
-	void DebugVelocity(glm::vec2 const& startPoint);
-
-	glm::vec2 m_position;
-	glm::vec2 m_ResolutionForceSum;
-	glm::vec2 m_velocity;
-	float m_mass;
-	float m_rotation;
-	float m_elasticity;
-
-	float m_angularVelocity = 0;
-
-	float m_drag;
-	float m_angularDrag;
-
-	bool m_bIsFilled;
-};
-
+#pragma once
+#include "PhysicsObject.h"
+#include "Transform.h"
+
+// What rendering reads of a body, captured at the end of a step
+struct BodyState
+{
+	glm::vec2 position = { 0,0 };
+	float rotation = 0;
+	glm::vec2 velocity = { 0,0 };
+	bool bIsFilled = true;
+};
+
+/***
+ * @brief Everything a step reads or writes of a body, as plain data so a
+ *			scene snapshot is one flat array
+ */
+struct BodySnapshot
+{
+	uint32_t uID = 0;
+	glm::vec2 position = { 0,0 };
+	glm::vec2 velocity = { 0,0 };
+	float rotation = 0;
+	float angularVelocity = 0;
+	// Poly and Stitched only. Resolution moves a body without updating its
+	// transform, so it can't be rebuilt from the pose.
+	Transform transform;
+	Bounds bounds = { { 0,0 }, { 0,0 } };
+	bool bIsFilled = true;
+};
+
+// Blends two captured states, an alpha of 0 gives prev and 1 gives curr
+inline BodyState LerpState(BodyState const& prev, BodyState const& curr, float alpha)
+{
+	BodyState result = curr;
+	result.position = glm::mix(prev.position, curr.position, alpha);
+	result.rotation = glm::mix(prev.rotation, curr.rotation, alpha);
+	result.velocity = glm::mix(prev.velocity, curr.velocity, alpha);
+	return result;
+}
+
+class RigidBody : public PhysicsObject {
+public:
+	RigidBody(ShapeID shapeID, glm::vec2 position, glm::vec2 velocity, float rotation, float fAngVelocity, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag);
+	virtual ~RigidBody();
+
+	virtual void fixedUpdate(glm::vec2 const& gravity, float timeStep);
+	virtual void debug();
+	void makeGizmo();
+
+	/***
+	 * @brief Draws the body as it was in a captured state, so rendering can
+	 *			work from a blended or buffered copy rather than the live body
+	 */
+	virtual void DrawGizmo(BodyState const& state) const = 0;
+	inline BodyState GetState() const { return { m_position, m_rotation, m_velocity, m_bIsFilled }; };
+
+	// Copies the body's state out for a scene snapshot, or back in from one
+	virtual void SaveSnapshot(BodySnapshot& snapshot) const;
+	virtual void LoadSnapshot(BodySnapshot const& snapshot);
+
+	void applyForce(glm::vec2 const& force);
+	void applyForceToActor(RigidBody* actor2, glm::vec2 const& force);
+
+	//virtual bool checkCollision(PhysicsObject* pOther) = 0;
+
+	inline void AddResolutionForce(glm::vec2 const& force) { m_ResolutionForceSum += force; };
+	inline void AddResolutionForceToActor(RigidBody* actor2, glm::vec2 const& force) { AddResolutionForce(force); actor2->AddResolutionForce(-force); }
+	inline void ApplyResolutionForce() { applyForce(m_ResolutionForceSum); m_ResolutionForceSum = { 0,0 }; };
+
+	// Moves the body outright, keeping anything derived from its pose in step
+	virtual void SetPose(glm::vec2 const& position, float rotation) { m_position = position; m_rotation = rotation; UpdateBounds(); };
+
+	inline void setPosition(glm::vec2 const& pos) { m_position = pos; }
+	inline glm::vec2 getPosition() const { return m_position; }
+	inline void setRotation(float const& rot) { m_rotation = rot; };
+	inline float getRotation() const { return m_rotation; }
+	inline void setVelocity(glm::vec2 const& velocity) { m_velocity = velocity; };
+	inline glm::vec2 getVelocity() const { return m_velocity; }
+	inline float getMass() const { return m_mass; }
+	inline float getElasticity() const { return m_elasticity; };
+	inline void setAngularVelocity(float const& angVel) { m_angularVelocity = angVel; };
+	inline float getAngularVelocity() const { return m_angularVelocity; };
+	inline void setAngularDrag(float const& angDrag) { m_angularDrag = angDrag; };
+	inline float getAngularDrag() const { return m_angularDrag; };
+	inline void setDrag(float const& drag) { m_drag = drag; };
+	inline float getDrag() const { return m_drag; };
+
+	inline bool GetIsFilled() const { return m_bIsFilled; };
+	inline void SetIsFilled(bool const& bIsFilled) { m_bIsFilled = bIsFilled; };
+	inline void InvertIsFilled() { m_bIsFilled = !m_bIsFilled; };
+	
+	void resolveCollision(RigidBody* actor2, glm::vec2 const& normal);
+	// The force resolveCollision applies to actor2, this body takes the opposite
+	glm::vec2 ResolutionForce(RigidBody const* actor2, glm::vec2 const& normal) const;
+protected:
+	void ApplyDrags(float const& timeStep);
+	void DebugVelocity(glm::vec2 const& startPoint, glm::vec2 const& velocity) const;
+
+	glm::vec2 m_position;
+	glm::vec2 m_ResolutionForceSum;
+	glm::vec2 m_velocity;
+	float m_mass;
+	float m_rotation;
+	float m_elasticity;
+
+	float m_angularVelocity = 0;
+
+	float m_drag;
+	float m_angularDrag;
+
+	bool m_bIsFilled;
+};
+
@@ -0,0 +1,60 @@
+#include "SceneBatch.h"
+#include "PhysicsScene.h"
+#include <chrono>
+
+SceneBatch::SceneBatch(aie::JobSystem& jobs) : m_Jobs(jobs)
+{
+}
+
+SceneBatch::~SceneBatch()
+{
+	for (Entry& entry : m_Scenes)
+		delete entry.pScene;
+}
+
+int SceneBatch::AddScene(PhysicsScene* pScene)
+{
+	Entry entry;
+	entry.pScene = pScene;
+
+	// No workers, the step graph runs on whichever thread steps the scene
+	entry.pJobs.reset(new aie::JobSystem(0));
+	pScene->SetJobSystem(entry.pJobs.get());
+
+	m_Scenes.push_back(std::move(entry));
+	return (int)m_Scenes.size() - 1;
+}
+
+void SceneBatch::Step(int stepCount)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	// Each job only writes its own scene and entry
+	m_Jobs.parallelFor(0, (int)m_Scenes.size(), 1, [this, stepCount](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			Entry& entry = m_Scenes[i];
+			auto sceneStart = std::chrono::steady_clock::now();
+
+			// Like Update, the events are only this Step's, so they don't grow forever
+			entry.pScene->ClearContactEvents();
+			for (int step = 0; step < stepCount; ++step)
+				entry.pScene->Step();
+
+			entry.stats.steps = stepCount;
+			entry.stats.fStepTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - sceneStart).count();
+			entry.stats.uTotalSteps += stepCount;
+			entry.stats.dTotalTime += entry.stats.fStepTime;
+		}
+	});
+
+	m_Stats.steps = stepCount * (int)m_Scenes.size();
+	m_Stats.fStepTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+	m_Stats.uTotalSteps += m_Stats.steps;
+	m_Stats.dTotalTime += m_Stats.fStepTime;
+
+	m_fSceneTime = 0;
+	for (Entry const& entry : m_Scenes)
+		m_fSceneTime += entry.stats.fStepTime;
+}
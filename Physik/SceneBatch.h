@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <JobSystem.h>
+
+using std::vector;
+
+class PhysicsScene;
+
+struct SceneBatchStats
+{
+	// fixed steps run by the last Step, and the wall clock seconds it took
+	int steps = 0;
+	float fStepTime = 0;
+	// totals since the scene was added, or the batch was made
+	uint64_t uTotalSteps = 0;
+	double dTotalTime = 0;
+
+	inline float GetStepsPerSecond() const { return fStepTime > 0 ? steps / fStepTime : 0; };
+	inline double GetTotalStepsPerSecond() const { return dTotalTime > 0 ? uTotalSteps / dTotalTime : 0; };
+};
+
+/***
+ * @brief Steps many independent scenes at once, one scene per job. Each scene
+ *			runs its step graph on its own inline job system, so a scene's step
+ *			stays on the worker that picked it up and scenes share nothing
+ *			while they step.
+ *
+ * There are no per scene arenas. A scene's step works only in storage the
+ *	scene owns and sizes in Reserve, and once warmed up it does not allocate
+ *	(the AllocGuard configuration checks this), so scenes never meet in the
+ *	heap while they step. Each scene's contact events are from the last Step.
+ *
+ * The batch owns its scenes. Scenes must not be touched while Step runs, and
+ *	their own Update, BeginStep and job system should be left alone while in
+ *	a batch.
+ */
+class SceneBatch
+{
+public:
+	SceneBatch(aie::JobSystem& jobs = aie::JobSystem::getDefault());
+	~SceneBatch();
+
+	// Returns the scene's index in the batch
+	int AddScene(PhysicsScene* pScene);
+	inline int GetSceneCount() const { return (int)m_Scenes.size(); };
+	inline PhysicsScene* GetScene(int index) const { return m_Scenes[index].pScene; };
+
+	// Runs stepCount fixed steps of every scene, returning when all are done
+	void Step(int stepCount = 1);
+
+	inline SceneBatchStats const& GetSceneStats(int index) const { return m_Scenes[index].stats; };
+	// steps and times summed over every scene, fStepTime and dTotalTime are wall clock
+	inline SceneBatchStats const& GetStats() const { return m_Stats; };
+	// seconds spent stepping scenes by the last Step, over its wall clock time
+	inline float GetParallelism() const { return m_Stats.fStepTime > 0 ? m_fSceneTime / m_Stats.fStepTime : 0; };
+
+private:
+	struct Entry
+	{
+		PhysicsScene* pScene;
+		std::unique_ptr<aie::JobSystem> pJobs;
+		SceneBatchStats stats;
+	};
+
+	aie::JobSystem& m_Jobs;
+	vector<Entry> m_Scenes;
+	SceneBatchStats m_Stats;
+	float m_fSceneTime = 0;
+};
@@ -0,0 +1,528 @@
+#include "SceneFile.h"
+#include "PhysicsScene.h"
+#include "Plane.h"
+#include "Sphere.h"
+#include "Box.h"
+#include "Poly.h"
+#include "Stitched.h"
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const char SCENE_FILE_MAGIC[4] = { 'P', 'H', 'Y', 'S' };
+
+static const size_t SECTION_RECORD_SIZE[(int)SceneFileSectionID::TOTAL] =
+{
+	sizeof(vec2),
+	sizeof(SceneFileNorm),
+	sizeof(SceneFileHull),
+	sizeof(SceneFileStitchedPoly),
+	sizeof(SceneFileNode),
+	sizeof(SceneFileStitched),
+	sizeof(SceneFileBody),
+};
+
+SceneFile::SceneFile()
+{
+}
+
+SceneFile::~SceneFile()
+{
+	Close();
+}
+
+bool SceneFile::Open(const char* path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	m_pFile = file;
+	m_pMapping = mapping;
+	m_pData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	m_size = (size_t)size.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping outlives the descriptor
+	void* pData = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	m_pData = pData == MAP_FAILED ? nullptr : pData;
+	m_size = (size_t)info.st_size;
+#endif
+
+	if (m_pData == nullptr || !Validate())
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void SceneFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData != nullptr)
+		UnmapViewOfFile(m_pData);
+	if (m_pMapping != nullptr)
+		CloseHandle((HANDLE)m_pMapping);
+	if (m_pFile != nullptr)
+		CloseHandle((HANDLE)m_pFile);
+#else
+	if (m_pData != nullptr)
+		munmap((void*)m_pData, m_size);
+#endif
+
+	m_pData = nullptr;
+	m_pMapping = nullptr;
+	m_pFile = nullptr;
+	m_size = 0;
+}
+
+bool SceneFile::Validate() const
+{
+	if (m_size < sizeof(SceneFileHeader))
+		return false;
+
+	SceneFileHeader const* pHeader = GetHeader();
+	if (memcmp(pHeader->magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC)) != 0 ||
+		pHeader->uVersion != VERSION || pHeader->uFileSize != m_size)
+		return false;
+
+	for (int i = 0; i < (int)SceneFileSectionID::TOTAL; ++i)
+	{
+		SceneFileSection const& section = pHeader->sections[i];
+		if (section.uOffset % SECTION_ALIGN != 0 || section.uOffset > m_size ||
+			section.uCount > (m_size - section.uOffset) / SECTION_RECORD_SIZE[i])
+			return false;
+	}
+
+	return true;
+}
+
+bool SceneFile::Load(PhysicsScene* pScene) const
+{
+	if (!IsOpen())
+		return false;
+
+	vec2 const* vertices = GetSection<vec2>(SceneFileSectionID::Vertices);
+	SceneFileNorm const* norms = GetSection<SceneFileNorm>(SceneFileSectionID::Norms);
+	SceneFileHull const* hulls = GetSection<SceneFileHull>(SceneFileSectionID::Hulls);
+	SceneFileStitchedPoly const* stitchedPolys = GetSection<SceneFileStitchedPoly>(SceneFileSectionID::StitchedPolys);
+	SceneFileNode const* nodes = GetSection<SceneFileNode>(SceneFileSectionID::StitchedNodes);
+	SceneFileStitched const* stitched = GetSection<SceneFileStitched>(SceneFileSectionID::Stitched);
+	SceneFileBody const* bodies = GetSection<SceneFileBody>(SceneFileSectionID::Bodies);
+
+	uint32_t vertexCount = GetCount(SceneFileSectionID::Vertices);
+	uint32_t hullCount = GetCount(SceneFileSectionID::Hulls);
+	uint32_t stitchedPolyCount = GetCount(SceneFileSectionID::StitchedPolys);
+	uint32_t nodeCount = GetCount(SceneFileSectionID::StitchedNodes);
+	uint32_t stitchedCount = GetCount(SceneFileSectionID::Stitched);
+	uint32_t bodyCount = GetCount(SceneFileSectionID::Bodies);
+
+	if (GetCount(SceneFileSectionID::Norms) != vertexCount)
+		return false;
+
+	// Geometry made here is shared between this file's bodies, it was cooked
+	// when the file was exported
+	vector<shared_ptr<const PolyGeometry>> hullGeometry(hullCount);
+	for (uint32_t i = 0; i < hullCount; ++i)
+	{
+		SceneFileHull const& hull = hulls[i];
+		if (hull.uFirstVertex > vertexCount || hull.uVertexCount > vertexCount - hull.uFirstVertex)
+			return false;
+
+		auto geometry = std::make_shared<PolyGeometry>();
+		geometry->vertices.assign(vertices + hull.uFirstVertex, vertices + hull.uFirstVertex + hull.uVertexCount);
+		geometry->sNorms.resize(hull.uVertexCount);
+		for (uint32_t j = 0; j < hull.uVertexCount; ++j)
+		{
+			geometry->sNorms[j].norm = norms[hull.uFirstVertex + j].norm;
+			geometry->sNorms[j].hasParallel = norms[hull.uFirstVertex + j].uHasParallel != 0;
+		}
+
+		geometry->fRadius = hull.fRadius;
+		geometry->fCentroidRadius = hull.fCentroidRadius;
+		geometry->centroid = hull.centroid;
+		geometry->boundsMin = hull.boundsMin;
+		geometry->boundsMax = hull.boundsMax;
+		hullGeometry[i] = geometry;
+	}
+
+	vector<shared_ptr<const StitchedGeometry>> stitchedGeometry(stitchedCount);
+	for (uint32_t i = 0; i < stitchedCount; ++i)
+	{
+		SceneFileStitched const& record = stitched[i];
+		if (record.uFirstPoly > stitchedPolyCount || record.uPolyCount > stitchedPolyCount - record.uFirstPoly ||
+			record.uFirstNode > nodeCount || record.uNodeCount > nodeCount - record.uFirstNode)
+			return false;
+
+		auto geometry = std::make_shared<StitchedGeometry>();
+		geometry->polys.reserve(record.uPolyCount);
+		geometry->polyOffsets.reserve(record.uPolyCount);
+		for (uint32_t j = 0; j < record.uPolyCount; ++j)
+		{
+			SceneFileStitchedPoly const& poly = stitchedPolys[record.uFirstPoly + j];
+			if (poly.uHull >= hullCount)
+				return false;
+
+			geometry->polys.push_back(hullGeometry[poly.uHull]);
+			geometry->polyOffsets.push_back(Transform(poly.offset, poly.fCos, poly.fSin));
+		}
+
+		// Children must come after their parent, as the builder writes them,
+		// so the tree can't loop, and no deeper than the traversal stack
+		geometry->bvh.resize(record.uNodeCount);
+		vector<int> depths(record.uNodeCount, 0);
+		for (uint32_t j = 0; j < record.uNodeCount; ++j)
+		{
+			SceneFileNode const& node = nodes[record.uFirstNode + j];
+			if (node.polyIndex >= (int32_t)record.uPolyCount ||
+				(node.polyIndex < 0 && (node.left <= (int32_t)j || node.right <= (int32_t)j ||
+					node.left >= (int32_t)record.uNodeCount || node.right >= (int32_t)record.uNodeCount)))
+				return false;
+
+			if (node.polyIndex < 0)
+			{
+				int depth = depths[j] + 1;
+				if (depth >= StitchedGeometry::BVH_STACK_SIZE)
+					return false;
+				if (depths[node.left] < depth)
+					depths[node.left] = depth;
+				if (depths[node.right] < depth)
+					depths[node.right] = depth;
+			}
+
+			geometry->bvh[j].boundsMin = node.boundsMin;
+			geometry->bvh[j].boundsMax = node.boundsMax;
+			geometry->bvh[j].left = node.left;
+			geometry->bvh[j].right = node.right;
+			geometry->bvh[j].polyIndex = node.polyIndex;
+		}
+
+		stitchedGeometry[i] = geometry;
+	}
+
+	// Every body is checked before the scene changes, so a bad file leaves it as it was
+	for (uint32_t i = 0; i < bodyCount; ++i)
+	{
+		SceneFileBody const& body = bodies[i];
+		switch ((ShapeID)body.uShape)
+		{
+		case ShapeID::Plane:
+		case ShapeID::Sphere:
+		case ShapeID::Box:
+			break;
+		case ShapeID::Poly:
+			if (body.uGeometry >= hullCount)
+				return false;
+			break;
+		case ShapeID::Stitched:
+			if (body.uGeometry >= stitchedCount)
+				return false;
+			break;
+		default:
+			return false;
+		}
+	}
+
+	SceneFileHeader const* pHeader = GetHeader();
+	pScene->setGravity(pHeader->gravity);
+	pScene->setTimeStep(pHeader->fTimeStep);
+	pScene->Reserve((int)pScene->GetActors().size() + (int)bodyCount);
+
+	for (uint32_t i = 0; i < bodyCount; ++i)
+	{
+		SceneFileBody const& body = bodies[i];
+		bool bIsFilled = (body.uFlags & SceneFileBody::FILLED) != 0;
+		PhysicsObject* pActor = nullptr;
+
+		switch ((ShapeID)body.uShape)
+		{
+		case ShapeID::Plane:
+		{
+			// Normalising the stored normal again can change its last bits
+			Plane* pPlane = new Plane(body.size, body.fDistance, body.fricCoStatic, body.fricCoKinetic);
+			pPlane->SetUnitNormal(body.size);
+			pActor = pPlane;
+			break;
+		}
+		case ShapeID::Sphere:
+		{
+			Sphere* pSphere = new Sphere(body.position, body.velocity, body.angularVelocity, body.mass, body.elasticity, body.fricCoStatic, body.fricCoKinetic, body.drag, body.angularDrag, body.size.x, body.colour);
+			pSphere->setRotation(body.rotation);
+			if ((body.uFlags & SceneFileBody::DIR_LINE) == 0)
+				pSphere->HideDirLine();
+			pActor = pSphere;
+			break;
+		}
+		case ShapeID::Box:
+		{
+			Box* pBox = new Box(body.size, body.position, body.velocity, body.mass, body.elasticity, body.fricCoStatic, body.fricCoKinetic, body.drag, body.angularDrag, body.colour, bIsFilled);
+			pBox->setRotation(body.rotation);
+			pBox->setAngularVelocity(body.angularVelocity);
+			pActor = pBox;
+			break;
+		}
+		case ShapeID::Poly:
+			pActor = new Poly(hullGeometry[body.uGeometry], body.position, body.velocity, body.rotation, body.angularVelocity, body.mass, body.elasticity, body.fricCoStatic, body.fricCoKinetic, body.drag, body.angularDrag, body.colour);
+			break;
+		case ShapeID::Stitched:
+			pActor = new Stitched(stitchedGeometry[body.uGeometry], body.position, body.velocity, body.rotation, body.angularVelocity, body.mass, body.elasticity, body.fricCoStatic, body.fricCoKinetic, body.drag, body.angularDrag, body.colour);
+			break;
+		default:
+			continue;
+		}
+
+		CollisionFilter filter;
+		filter.uCategory = body.uCategory;
+		filter.uMask = body.uCollisionMask;
+		filter.uGroup = body.uCollisionGroup;
+		pActor->SetCollisionFilter(filter);
+		pActor->SetSensor((body.uFlags & SceneFileBody::SENSOR) != 0);
+
+		if (body.uShape != (uint32_t)ShapeID::Plane)
+			((RigidBody*)pActor)->SetIsFilled(bIsFilled);
+
+		pScene->AddActor(pActor);
+	}
+
+	return true;
+}
+
+/***
+ * @brief Collects cooked geometry for export, each distinct geometry once
+ */
+struct SceneFileWriter
+{
+	vector<vec2> vertices;
+	vector<SceneFileNorm> norms;
+	vector<SceneFileHull> hulls;
+	vector<SceneFileStitchedPoly> stitchedPolys;
+	vector<SceneFileNode> nodes;
+	vector<SceneFileStitched> stitched;
+	vector<SceneFileBody> bodies;
+
+	std::unordered_map<PolyGeometry const*, uint32_t> hullIndices;
+	std::unordered_map<StitchedGeometry const*, uint32_t> stitchedIndices;
+
+	uint32_t AddHull(PolyGeometry const& geometry)
+	{
+		auto it = hullIndices.find(&geometry);
+		if (it != hullIndices.end())
+			return it->second;
+
+		SceneFileHull hull = {};
+		hull.uFirstVertex = (uint32_t)vertices.size();
+		hull.uVertexCount = (uint32_t)geometry.vertices.size();
+		hull.fRadius = geometry.fRadius;
+		hull.fCentroidRadius = geometry.fCentroidRadius;
+		hull.centroid = geometry.centroid;
+		hull.boundsMin = geometry.boundsMin;
+		hull.boundsMax = geometry.boundsMax;
+
+		for (int i = 0; i < (int)geometry.vertices.size(); ++i)
+		{
+			vertices.push_back(geometry.vertices[i]);
+
+			SceneFileNorm norm = {};
+			if (i < (int)geometry.sNorms.size())
+			{
+				norm.norm = geometry.sNorms[i].norm;
+				norm.uHasParallel = geometry.sNorms[i].hasParallel ? 1 : 0;
+			}
+			norms.push_back(norm);
+		}
+
+		uint32_t index = (uint32_t)hulls.size();
+		hulls.push_back(hull);
+		hullIndices[&geometry] = index;
+		return index;
+	}
+
+	uint32_t AddStitched(StitchedGeometry const& geometry)
+	{
+		auto it = stitchedIndices.find(&geometry);
+		if (it != stitchedIndices.end())
+			return it->second;
+
+		SceneFileStitched record = {};
+		record.uFirstPoly = (uint32_t)stitchedPolys.size();
+		record.uPolyCount = (uint32_t)geometry.polys.size();
+		record.uFirstNode = (uint32_t)nodes.size();
+		record.uNodeCount = (uint32_t)geometry.bvh.size();
+
+		for (int i = 0; i < (int)geometry.polys.size(); ++i)
+		{
+			SceneFileStitchedPoly poly = {};
+			poly.uHull = AddHull(*geometry.polys[i]);
+			poly.fCos = geometry.polyOffsets[i].GetCos();
+			poly.fSin = geometry.polyOffsets[i].GetSin();
+			poly.offset = geometry.polyOffsets[i].GetPosition();
+			stitchedPolys.push_back(poly);
+		}
+
+		for (int i = 0; i < (int)geometry.bvh.size(); ++i)
+		{
+			SceneFileNode node = {};
+			node.boundsMin = geometry.bvh[i].boundsMin;
+			node.boundsMax = geometry.bvh[i].boundsMax;
+			node.left = geometry.bvh[i].left;
+			node.right = geometry.bvh[i].right;
+			node.polyIndex = geometry.bvh[i].polyIndex;
+			nodes.push_back(node);
+		}
+
+		uint32_t index = (uint32_t)stitched.size();
+		stitched.push_back(record);
+		stitchedIndices[&geometry] = index;
+		return index;
+	}
+
+	// Appends records at the next aligned offset, padding with zeroes
+	template <class T>
+	static void WriteSection(vector<unsigned char>& buffer, SceneFileSection& section, vector<T> const& records)
+	{
+		size_t offset = (buffer.size() + SceneFile::SECTION_ALIGN - 1) / SceneFile::SECTION_ALIGN * SceneFile::SECTION_ALIGN;
+		buffer.resize(offset + records.size() * sizeof(T));
+		if (!records.empty())
+			memcpy(&buffer[offset], records.data(), records.size() * sizeof(T));
+
+		section.uOffset = (uint32_t)offset;
+		section.uCount = (uint32_t)records.size();
+	}
+};
+
+bool SceneFile::Export(PhysicsScene const& scene, const char* path)
+{
+	SceneFileWriter writer;
+	vector<PhysicsObject*> const& actors = scene.GetActors();
+
+	for (int i = 0; i < (int)actors.size(); ++i)
+	{
+		PhysicsObject* pActor = actors[i];
+
+		SceneFileBody body = {};
+		body.uShape = (uint32_t)pActor->getShapeID();
+		body.fricCoStatic = pActor->GetStaticFricCo();
+		body.fricCoKinetic = pActor->GetKineticFricCo();
+		body.uCategory = pActor->GetCollisionFilter().uCategory;
+		body.uCollisionMask = pActor->GetCollisionFilter().uMask;
+		body.uCollisionGroup = pActor->GetCollisionFilter().uGroup;
+		if (pActor->IsSensor())
+			body.uFlags |= SceneFileBody::SENSOR;
+
+		if (pActor->getShapeID() == ShapeID::Plane)
+		{
+			Plane* pPlane = (Plane*)pActor;
+			body.size = pPlane->getNormal();
+			body.fDistance = pPlane->getDistance();
+			writer.bodies.push_back(body);
+			continue;
+		}
+
+		RigidBody* pBody = (RigidBody*)pActor;
+		if (pBody->GetIsFilled())
+			body.uFlags |= SceneFileBody::FILLED;
+		body.position = pBody->getPosition();
+		body.velocity = pBody->getVelocity();
+		body.rotation = pBody->getRotation();
+		body.angularVelocity = pBody->getAngularVelocity();
+		body.mass = pBody->getMass();
+		body.elasticity = pBody->getElasticity();
+		body.drag = pBody->getDrag();
+		body.angularDrag = pBody->getAngularDrag();
+
+		switch (pActor->getShapeID())
+		{
+		case ShapeID::Sphere:
+		{
+			Sphere* pSphere = (Sphere*)pActor;
+			body.size = vec2(pSphere->getRadius(), 0);
+			body.colour = pSphere->getColour();
+			if (pSphere->GetDirLine())
+				body.uFlags |= SceneFileBody::DIR_LINE;
+			break;
+		}
+		case ShapeID::Box:
+			body.size = ((Box*)pActor)->getExtents();
+			body.colour = ((Box*)pActor)->getColour();
+			break;
+		case ShapeID::Poly:
+			body.uGeometry = writer.AddHull(*((Poly*)pActor)->GetGeometry());
+			body.colour = ((Poly*)pActor)->GetColour();
+			break;
+		case ShapeID::Stitched:
+			body.uGeometry = writer.AddStitched(*((Stitched*)pActor)->GetGeometry());
+			body.colour = ((Stitched*)pActor)->GetColour();
+			break;
+		default:
+			break;
+		}
+
+		writer.bodies.push_back(body);
+	}
+
+	SceneFileHeader header = {};
+	memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC));
+	header.uVersion = VERSION;
+	header.fTimeStep = scene.getTimeStep();
+	header.gravity = scene.getGravity();
+
+	vector<unsigned char> buffer(sizeof(SceneFileHeader));
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::Vertices], writer.vertices);
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::Norms], writer.norms);
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::Hulls], writer.hulls);
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::StitchedPolys], writer.stitchedPolys);
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::StitchedNodes], writer.nodes);
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::Stitched], writer.stitched);
+	SceneFileWriter::WriteSection(buffer, header.sections[(int)SceneFileSectionID::Bodies], writer.bodies);
+
+	header.uFileSize = (uint32_t)buffer.size();
+	memcpy(&buffer[0], &header, sizeof(header));
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return false;
+
+	file.write((char const*)buffer.data(), buffer.size());
+	return (bool)file;
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <glm/ext.hpp>
+#include <cstdint>
+#include <cstddef>
+
+using namespace glm;
+
+class PhysicsScene;
+
+/***
+ * Binary scene layout. A header, then sections of fixed size records, each
+ *	starting on a SECTION_ALIGN boundary. Offsets are from the start of the
+ *	file, so a mapped file is read in place. Little endian.
+ */
+enum class SceneFileSectionID : uint32_t
+{
+	Vertices = 0,
+	Norms,
+	Hulls,
+	StitchedPolys,
+	StitchedNodes,
+	Stitched,
+	Bodies,
+
+	TOTAL
+};
+
+struct SceneFileSection
+{
+	uint32_t uOffset;
+	uint32_t uCount;
+};
+
+struct SceneFileHeader
+{
+	char magic[4];
+	uint32_t uVersion;
+	// checked against the size of the mapped file
+	uint32_t uFileSize;
+	float fTimeStep;
+	vec2 gravity;
+	SceneFileSection sections[(int)SceneFileSectionID::TOTAL];
+};
+
+// One per edge, same index as the edge's first vertex
+struct SceneFileNorm
+{
+	vec2 norm;
+	uint32_t uHasParallel;
+};
+
+// A cooked PolyGeometry
+struct SceneFileHull
+{
+	// into both Vertices and Norms
+	uint32_t uFirstVertex;
+	uint32_t uVertexCount;
+	float fRadius;
+	float fCentroidRadius;
+	vec2 centroid;
+	vec2 boundsMin;
+	vec2 boundsMax;
+};
+
+// A Stitched sub-poly and its offset from the body
+struct SceneFileStitchedPoly
+{
+	uint32_t uHull;
+	float fCos;
+	float fSin;
+	vec2 offset;
+};
+
+struct SceneFileNode
+{
+	vec2 boundsMin;
+	vec2 boundsMax;
+	// children are only valid when polyIndex is -1
+	int32_t left;
+	int32_t right;
+	int32_t polyIndex;
+};
+
+// A cooked StitchedGeometry, its polys and BVH nodes are contiguous runs
+struct SceneFileStitched
+{
+	uint32_t uFirstPoly;
+	uint32_t uPolyCount;
+	uint32_t uFirstNode;
+	uint32_t uNodeCount;
+};
+
+struct SceneFileBody
+{
+	enum Flags : uint32_t
+	{
+		FILLED = 1 << 0,
+		DIR_LINE = 1 << 1,
+		SENSOR = 1 << 2,
+	};
+
+	// a ShapeID
+	uint32_t uShape;
+	// hull for a Poly, stitched geometry for a Stitched
+	uint32_t uGeometry;
+	uint32_t uFlags;
+	vec2 position;
+	vec2 velocity;
+	float rotation;
+	float angularVelocity;
+	float mass;
+	float elasticity;
+	float fricCoStatic;
+	float fricCoKinetic;
+	float drag;
+	float angularDrag;
+	// sphere radius in x, box extents, or plane normal
+	vec2 size;
+	// plane distance to the origin
+	float fDistance;
+	vec4 colour;
+	// CollisionFilter
+	uint32_t uCategory;
+	uint32_t uCollisionMask;
+	uint32_t uCollisionGroup;
+};
+
+/***
+ * @brief A scene file mapped into memory. The cooked geometry and BVHs are
+ *			copied out as whole arrays, nothing is cooked or rebuilt on load.
+ */
+class SceneFile
+{
+public:
+	static const uint32_t VERSION = 2;
+	static const uint32_t SECTION_ALIGN = 16;
+
+	SceneFile();
+	~SceneFile();
+
+	// Maps a file, false if it can't be read or isn't a scene of this version
+	bool Open(const char* path);
+	void Close();
+	inline bool IsOpen() const { return m_pData != nullptr; };
+
+	// Adds the file's bodies to a scene and sets its gravity and time step,
+	// false and the scene untouched if any record is malformed
+	bool Load(PhysicsScene* pScene) const;
+
+	/***
+	 * @brief Writes every actor in a scene with its cooked geometry. Geometry
+	 *			shared by several bodies is written once.
+	 */
+	static bool Export(PhysicsScene const& scene, const char* path);
+
+	inline SceneFileHeader const* GetHeader() const { return (SceneFileHeader const*)m_pData; };
+	inline uint32_t GetCount(SceneFileSectionID id) const { return GetHeader()->sections[(int)id].uCount; };
+
+	template <class T>
+	T const* GetSection(SceneFileSectionID id) const
+	{
+		return (T const*)((unsigned char const*)m_pData + GetHeader()->sections[(int)id].uOffset);
+	}
+
+private:
+	bool Validate() const;
+
+	void const* m_pData = nullptr;
+	size_t m_size = 0;
+
+	// platform handles for the mapping
+	void* m_pFile = nullptr;
+	void* m_pMapping = nullptr;
+};
@@ -0,0 +1,882 @@
+#include "SceneQuery.h"
+#include "Plane.h"
+#include "Sphere.h"
+#include "Box.h"
+#include "Poly.h"
+#include "Stitched.h"
+
+/***
+ * World space views of the hulls a shape cast sweeps. Edge i runs from vertex
+ *	i to vertex i + 1 and normal i faces out of it.
+ */
+struct PolyHull
+{
+	PolyHull(Poly* poly, float sign) : pPoly(poly), position(poly->getPosition()), fSign(sign) {};
+
+	inline int Count() const { return pPoly->GetVerticeCount(); };
+	inline vec2 Vertex(int i) const { return position + pPoly->GetRotatedVert(i); };
+	inline vec2 Normal(int i) const { return pPoly->GetRotatedSNorm(i) * fSign; };
+	// parallel normals give the same SAT axis
+	inline bool SkipAxis(int i) const { return pPoly->GetSNormParallel(i); };
+	inline void Project(vec2 const& axis, float& min, float& max) const { pPoly->Project(axis, min, max); };
+
+	Poly* pPoly;
+	vec2 position;
+	float fSign;
+};
+
+struct BoxHull
+{
+	BoxHull(Box* box) : center(box->getPosition()), extents(box->getExtents()) {};
+
+	inline int Count() const { return 4; };
+	inline vec2 Vertex(int i) const
+	{
+		static const vec2 corners[4] = { { -1,-1 }, { 1,-1 }, { 1,1 }, { -1,1 } };
+		return center + extents * corners[i];
+	};
+	inline vec2 Normal(int i) const
+	{
+		static const vec2 normals[4] = { { 0,-1 }, { 1,0 }, { 0,1 }, { -1,0 } };
+		return normals[i];
+	};
+	// the last two normals are the first two reversed
+	inline bool SkipAxis(int i) const { return i >= 2; };
+	inline void Project(vec2 const& axis, float& min, float& max) const
+	{
+		float c = dot(axis, center);
+		float r = extents.x * abs(axis.x) + extents.y * abs(axis.y);
+		min = c - r;
+		max = c + r;
+	};
+
+	vec2 center;
+	vec2 extents;
+};
+
+// The hull vertex furthest along a direction
+template <class H>
+static vec2 HullSupport(H const& hull, vec2 const& direction)
+{
+	vec2 best = hull.Vertex(0);
+	float bestDot = dot(best, direction);
+	for (int i = 1; i < hull.Count(); ++i)
+	{
+		vec2 vertex = hull.Vertex(i);
+		if (dot(vertex, direction) > bestDot)
+		{
+			best = vertex;
+			bestDot = dot(vertex, direction);
+		}
+	}
+
+	return best;
+}
+
+template <class H>
+static bool HullOverlapsCircle(H const& hull, vec2 const& center, float radius)
+{
+	bool bInside = true;
+	for (int i = 0; i < hull.Count(); ++i)
+	{
+		vec2 start = hull.Vertex(i);
+		if (dot(hull.Normal(i), center - start) > 0)
+			bInside = false;
+
+		vec2 edge = hull.Vertex(i + 1 < hull.Count() ? i + 1 : 0) - start;
+		float edgeLengthSq = dot(edge, edge);
+		float t = edgeLengthSq > 0 ? clamp(dot(center - start, edge) / edgeLengthSq, 0.0f, 1.0f) : 0;
+
+		vec2 offset = start + edge * t - center;
+		if (dot(offset, offset) <= radius * radius)
+			return true;
+	}
+
+	return bInside;
+}
+
+// An overlap at the start has no direction of approach, face back along the sweep
+static inline vec2 StartNormal(vec2 const& displacement)
+{
+	return displacement == vec2(0, 0) ? vec2(0, 0) : -normalize(displacement);
+}
+
+/***
+ * @brief Swept SAT. Along each axis the moving hull's interval overlaps the
+ *			target's for a span of time, the hulls touch where every span does.
+ */
+template <class A, class B>
+static bool SweepHulls(A const& moving, vec2 const& displacement, B const& target, ShapeCastHit& hit)
+{
+	float tEnter = -FLT_MAX;
+	float tExit = FLT_MAX;
+	vec2 enterNormal = { 0,0 };
+	bool bEnterOnMoving = false;
+
+	auto sweepAxis = [&](vec2 const& axis, bool bMovingAxis)
+	{
+		float movingMin, movingMax, targetMin, targetMax;
+		moving.Project(axis, movingMin, movingMax);
+		target.Project(axis, targetMin, targetMax);
+
+		float fSpeed = dot(displacement, axis);
+		if (fSpeed == 0)
+			return movingMax >= targetMin && movingMin <= targetMax;
+
+		float t0, t1;
+		vec2 normal;
+		if (fSpeed > 0)
+		{
+			t0 = (targetMin - movingMax) / fSpeed;
+			t1 = (targetMax - movingMin) / fSpeed;
+			normal = -axis;
+		}
+		else
+		{
+			t0 = (targetMax - movingMin) / fSpeed;
+			t1 = (targetMin - movingMax) / fSpeed;
+			normal = axis;
+		}
+
+		if (t0 > tEnter)
+		{
+			tEnter = t0;
+			enterNormal = normal;
+			bEnterOnMoving = bMovingAxis;
+		}
+		tExit = glm::min(tExit, t1);
+
+		return tEnter <= tExit && tEnter <= 1 && tExit >= 0;
+	};
+
+	for (int i = 0; i < moving.Count(); ++i)
+	{
+		if (!moving.SkipAxis(i) && !sweepAxis(moving.Normal(i), true))
+			return false;
+	}
+
+	for (int i = 0; i < target.Count(); ++i)
+	{
+		if (!target.SkipAxis(i) && !sweepAxis(target.Normal(i), false))
+			return false;
+	}
+
+	if (tEnter < 0)
+	{
+		hit.fTime = 0;
+		hit.normal = StartNormal(displacement);
+		hit.point = HullSupport(moving, displacement);
+		return true;
+	}
+
+	hit.fTime = tEnter;
+	hit.normal = enterNormal;
+
+	// The moving hull's face meets a target vertex, or the other way round
+	if (bEnterOnMoving)
+		hit.point = HullSupport(target, enterNormal);
+	else
+		hit.point = HullSupport(moving, -enterNormal) + displacement * tEnter;
+	return true;
+}
+
+/***
+ * @brief Sweeps a circle's centre against a hull grown by its radius: the
+ *			hull's edges pushed out by the radius, and a circle on each vertex.
+ *			The normal faces out of the hull.
+ */
+template <class B>
+static bool SweepCircle(vec2 const& center, float radius, vec2 const& displacement, B const& target, ShapeCastHit& hit)
+{
+	if (HullOverlapsCircle(target, center, radius))
+	{
+		hit.fTime = 0;
+		hit.normal = StartNormal(displacement);
+		hit.point = center;
+		return true;
+	}
+
+	float fLengthSq = dot(displacement, displacement);
+	if (fLengthSq == 0)
+		return false;
+
+	float best = FLT_MAX;
+	vec2 bestNormal = { 0,0 };
+
+	for (int i = 0; i < target.Count(); ++i)
+	{
+		vec2 normal = target.Normal(i);
+		float fApproach = dot(displacement, normal);
+		if (fApproach >= 0)
+			continue;
+
+		vec2 start = target.Vertex(i) + normal * radius;
+		vec2 edge = target.Vertex(i + 1 < target.Count() ? i + 1 : 0) + normal * radius - start;
+
+		float t = dot(start - center, normal) / fApproach;
+		if (t < 0 || t > 1 || t >= best)
+			continue;
+
+		float s = dot(center + displacement * t - start, edge);
+		if (s >= 0 && s <= dot(edge, edge))
+		{
+			best = t;
+			bestNormal = normal;
+		}
+	}
+
+	for (int i = 0; i < target.Count(); ++i)
+	{
+		vec2 toCenter = center - target.Vertex(i);
+		float b = dot(toCenter, displacement);
+		float c = dot(toCenter, toCenter) - radius * radius;
+		if (b >= 0)
+			continue;
+
+		float discriminant = b * b - fLengthSq * c;
+		if (discriminant < 0)
+			continue;
+
+		float t = (-b - sqrtf(discriminant)) / fLengthSq;
+		if (t >= 0 && t <= 1 && t < best)
+		{
+			best = t;
+			bestNormal = normalize(center + displacement * t - target.Vertex(i));
+		}
+	}
+
+	if (best == FLT_MAX)
+		return false;
+
+	hit.fTime = best;
+	hit.normal = bestNormal;
+	hit.point = center + displacement * best - bestNormal * radius;
+	return true;
+}
+
+// Swept SAT on the plane's normal alone, a line has no other axis
+template <class A>
+static bool SweepHullPlane(A const& moving, vec2 const& displacement, Plane* plane, ShapeCastHit& hit)
+{
+	vec2 normal = plane->getNormal();
+	float distance = plane->getDistance();
+
+	float movingMin, movingMax;
+	moving.Project(normal, movingMin, movingMax);
+
+	if (movingMin <= distance && movingMax >= distance)
+	{
+		hit.fTime = 0;
+		hit.normal = StartNormal(displacement);
+		hit.point = HullSupport(moving, displacement);
+		return true;
+	}
+
+	float fSpeed = dot(displacement, normal);
+	bool bAbove = movingMin > distance;
+	if (fSpeed == 0 || (fSpeed > 0) == bAbove)
+		return false;
+
+	float t = ((bAbove ? movingMin : movingMax) - distance) / -fSpeed;
+	if (t > 1)
+		return false;
+
+	hit.fTime = t;
+	hit.normal = bAbove ? normal : -normal;
+	hit.point = HullSupport(moving, -hit.normal) + displacement * t;
+	return true;
+}
+
+// A hull swept onto a still sphere is the sphere swept back onto the hull
+template <class A>
+static bool SweepHullSphere(A const& moving, vec2 const& displacement, Sphere* sphere, ShapeCastHit& hit)
+{
+	if (!SweepCircle(sphere->getPosition(), sphere->getRadius(), -displacement, moving, hit))
+		return false;
+
+	if (hit.fTime > 0)
+	{
+		// SweepCircle's normal faces out of the moving hull
+		hit.normal = -hit.normal;
+		hit.point = sphere->getPosition() + hit.normal * sphere->getRadius();
+	}
+	else
+	{
+		hit.normal = StartNormal(displacement);
+	}
+	return true;
+}
+
+bool SceneQuery::Raycast(Plane* plane, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit)
+{
+	vec2 normal = plane->getNormal();
+	float originToPlane = dot(origin, normal) - plane->getDistance();
+	float fApproach = dot(direction, normal);
+
+	if (originToPlane == 0)
+	{
+		hit.fDistance = 0;
+		hit.point = origin;
+		hit.normal = -direction;
+		return true;
+	}
+
+	if (fApproach == 0)
+		return false;
+
+	float t = -originToPlane / fApproach;
+	if (t < 0 || t > fMaxDistance)
+		return false;
+
+	hit.fDistance = t;
+	hit.point = origin + direction * t;
+	hit.normal = originToPlane > 0 ? normal : -normal;
+	return true;
+}
+
+bool SceneQuery::Raycast(Sphere* sphere, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit)
+{
+	vec2 center = sphere->getPosition();
+	float radius = sphere->getRadius();
+
+	vec2 toOrigin = origin - center;
+	float b = dot(toOrigin, direction);
+	float c = dot(toOrigin, toOrigin) - radius * radius;
+
+	if (c <= 0)
+	{
+		hit.fDistance = 0;
+		hit.point = origin;
+		hit.normal = -direction;
+		return true;
+	}
+
+	// Outside and pointing away
+	if (b > 0)
+		return false;
+
+	float discriminant = b * b - c;
+	if (discriminant < 0)
+		return false;
+
+	float t = -b - sqrtf(discriminant);
+	if (t > fMaxDistance)
+		return false;
+
+	hit.fDistance = t;
+	hit.point = origin + direction * t;
+	hit.normal = normalize(hit.point - center);
+	return true;
+}
+
+bool SceneQuery::Raycast(Box* box, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit)
+{
+	vec2 extents = box->getExtents();
+	vec2 position = box->getPosition();
+
+	if (!RaycastBounds(position - extents, position + extents, origin, direction, fMaxDistance, hit.fDistance, hit.normal))
+		return false;
+
+	hit.point = origin + direction * hit.fDistance;
+	return true;
+}
+
+bool SceneQuery::Raycast(Poly* poly, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit)
+{
+	int count = poly->GetVerticeCount();
+	if (count < 3)
+		return false;
+
+	float sign = NormalSign(poly);
+	vec2 position = poly->getPosition();
+
+	// Clip the ray against each edge's half plane
+	float tEnter = -FLT_MAX;
+	float tExit = fMaxDistance;
+	vec2 enterNormal = -direction;
+
+	for (int i = 0; i < count; ++i)
+	{
+		vec2 normal = poly->GetRotatedSNorm(i) * sign;
+		vec2 vertex = position + poly->GetRotatedVert(i);
+
+		float fInside = dot(normal, vertex - origin);
+		float fApproach = dot(normal, direction);
+
+		if (fApproach == 0)
+		{
+			if (fInside < 0)
+				return false;
+			continue;
+		}
+
+		float t = fInside / fApproach;
+		if (fApproach < 0)
+		{
+			if (t > tEnter)
+			{
+				tEnter = t;
+				enterNormal = normal;
+			}
+		}
+		else
+		{
+			tExit = glm::min(tExit, t);
+		}
+
+		if (tEnter > tExit)
+			return false;
+	}
+
+	if (tExit < 0)
+		return false;
+
+	if (tEnter < 0)
+	{
+		tEnter = 0;
+		enterNormal = -direction;
+	}
+
+	hit.fDistance = tEnter;
+	hit.point = origin + direction * tEnter;
+	hit.normal = enterNormal;
+	return true;
+}
+
+bool SceneQuery::Raycast(Stitched* stitched, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit)
+{
+	// The segment's bounds in the body's space only need its two ends
+	Transform const& transform = stitched->GetTransform();
+	vec2 localStart = transform.InvTransformPoint(origin);
+	vec2 localEnd = transform.InvTransformPoint(origin + direction * fMaxDistance);
+
+	bool bHit = false;
+	stitched->GetGeometry()->ForEachPolyInBounds(min(localStart, localEnd), max(localStart, localEnd), [&](int polyIndex)
+	{
+		RaycastHit polyHit;
+		if (Raycast(stitched->GetPoly(polyIndex), origin, direction, fMaxDistance, polyHit))
+		{
+			hit = polyHit;
+			fMaxDistance = polyHit.fDistance;
+			bHit = true;
+		}
+	});
+
+	return bHit;
+}
+
+bool SceneQuery::OverlapPoint(Plane* plane, vec2 const& point)
+{
+	return false;
+}
+
+bool SceneQuery::OverlapPoint(Sphere* sphere, vec2 const& point)
+{
+	vec2 offset = point - sphere->getPosition();
+	return dot(offset, offset) <= sphere->getRadius() * sphere->getRadius();
+}
+
+bool SceneQuery::OverlapPoint(Box* box, vec2 const& point)
+{
+	vec2 offset = abs(point - box->getPosition());
+	vec2 extents = box->getExtents();
+	return offset.x <= extents.x && offset.y <= extents.y;
+}
+
+bool SceneQuery::OverlapPoint(Poly* poly, vec2 const& point)
+{
+	int count = poly->GetVerticeCount();
+	if (count < 3)
+		return false;
+
+	float sign = NormalSign(poly);
+	vec2 position = poly->getPosition();
+
+	for (int i = 0; i < count; ++i)
+	{
+		vec2 normal = poly->GetRotatedSNorm(i) * sign;
+		if (dot(normal, point - position - poly->GetRotatedVert(i)) > 0)
+			return false;
+	}
+
+	return true;
+}
+
+bool SceneQuery::OverlapPoint(Stitched* stitched, vec2 const& point)
+{
+	vec2 local = stitched->GetTransform().InvTransformPoint(point);
+
+	bool bOverlap = false;
+	stitched->GetGeometry()->ForEachPolyInBounds(local, local, [&](int polyIndex)
+	{
+		bOverlap = bOverlap || OverlapPoint(stitched->GetPoly(polyIndex), point);
+	});
+
+	return bOverlap;
+}
+
+bool SceneQuery::OverlapAABB(Plane* plane, Bounds const& bounds)
+{
+	return plane->OverlapsBounds(bounds);
+}
+
+bool SceneQuery::OverlapAABB(Sphere* sphere, Bounds const& bounds)
+{
+	vec2 center = sphere->getPosition();
+	vec2 offset = clamp(center, bounds.min, bounds.max) - center;
+	return dot(offset, offset) <= sphere->getRadius() * sphere->getRadius();
+}
+
+bool SceneQuery::OverlapAABB(Box* box, Bounds const& bounds)
+{
+	vec2 extents = box->getExtents();
+	Bounds boxBounds = { box->getPosition() - extents, box->getPosition() + extents };
+	return BoundsOverlap(boxBounds, bounds);
+}
+
+bool SceneQuery::OverlapAABB(Poly* poly, Bounds const& bounds)
+{
+	int count = poly->GetVerticeCount();
+	if (count < 3)
+		return false;
+
+	// SAT, the box's axes first then the poly's edge normals
+	float polyMin, polyMax;
+	poly->Project(vec2(1, 0), polyMin, polyMax);
+	if (polyMin > bounds.max.x || polyMax < bounds.min.x)
+		return false;
+
+	poly->Project(vec2(0, 1), polyMin, polyMax);
+	if (polyMin > bounds.max.y || polyMax < bounds.min.y)
+		return false;
+
+	vec2 center = (bounds.min + bounds.max) * 0.5f;
+	vec2 extents = (bounds.max - bounds.min) * 0.5f;
+
+	for (int i = 0; i < count; ++i)
+	{
+		if (poly->GetSNormParallel(i))
+			continue;
+
+		vec2 axis = poly->GetRotatedSNorm(i);
+		float boxCenter = dot(axis, center);
+		float boxRadius = extents.x * abs(axis.x) + extents.y * abs(axis.y);
+
+		poly->Project(axis, polyMin, polyMax);
+		if (polyMin > boxCenter + boxRadius || polyMax < boxCenter - boxRadius)
+			return false;
+	}
+
+	return true;
+}
+
+bool SceneQuery::OverlapAABB(Stitched* stitched, Bounds const& bounds)
+{
+	// Box the query's corners in the body's space
+	Transform const& transform = stitched->GetTransform();
+	vec2 corners[4] =
+	{
+		transform.InvTransformPoint(bounds.min),
+		transform.InvTransformPoint(bounds.max),
+		transform.InvTransformPoint({ bounds.min.x, bounds.max.y }),
+		transform.InvTransformPoint({ bounds.max.x, bounds.min.y }),
+	};
+
+	vec2 localMin = min(min(corners[0], corners[1]), min(corners[2], corners[3]));
+	vec2 localMax = max(max(corners[0], corners[1]), max(corners[2], corners[3]));
+
+	bool bOverlap = false;
+	stitched->GetGeometry()->ForEachPolyInBounds(localMin, localMax, [&](int polyIndex)
+	{
+		bOverlap = bOverlap || OverlapAABB(stitched->GetPoly(polyIndex), bounds);
+	});
+
+	return bOverlap;
+}
+
+bool SceneQuery::OverlapCircle(Plane* plane, vec2 const& center, float radius)
+{
+	return abs(dot(center, plane->getNormal()) - plane->getDistance()) <= radius;
+}
+
+bool SceneQuery::OverlapCircle(Sphere* sphere, vec2 const& center, float radius)
+{
+	float radiusSum = sphere->getRadius() + radius;
+	vec2 offset = center - sphere->getPosition();
+	return dot(offset, offset) <= radiusSum * radiusSum;
+}
+
+bool SceneQuery::OverlapCircle(Box* box, vec2 const& center, float radius)
+{
+	vec2 extents = box->getExtents();
+	vec2 offset = clamp(center, box->getPosition() - extents, box->getPosition() + extents) - center;
+	return dot(offset, offset) <= radius * radius;
+}
+
+bool SceneQuery::OverlapCircle(Poly* poly, vec2 const& center, float radius)
+{
+	if (OverlapPoint(poly, center))
+		return true;
+
+	// Outside, so the nearest point is on an edge
+	int count = poly->GetVerticeCount();
+	vec2 position = poly->getPosition();
+
+	for (int i = 0; i < count; ++i)
+	{
+		vec2 start = position + poly->GetRotatedVert(i);
+		vec2 edge = position + poly->GetRotatedVert(i + 1 < count ? i + 1 : 0) - start;
+
+		float t = dot(center - start, edge);
+		float edgeLengthSq = dot(edge, edge);
+		t = edgeLengthSq > 0 ? clamp(t / edgeLengthSq, 0.0f, 1.0f) : 0;
+
+		vec2 offset = start + edge * t - center;
+		if (dot(offset, offset) <= radius * radius)
+			return true;
+	}
+
+	return false;
+}
+
+bool SceneQuery::OverlapCircle(Stitched* stitched, vec2 const& center, float radius)
+{
+	bool bOverlap = false;
+	stitched->ForEachPolyNear(center, radius, [&](int polyIndex)
+	{
+		bOverlap = bOverlap || OverlapCircle(stitched->GetPoly(polyIndex), center, radius);
+	});
+
+	return bOverlap;
+}
+
+bool SceneQuery::ShapeCast(Sphere* sphere, vec2 const& displacement, Plane* plane, ShapeCastHit& hit)
+{
+	vec2 center = sphere->getPosition();
+	float radius = sphere->getRadius();
+	float centerToPlane = dot(center, plane->getNormal()) - plane->getDistance();
+	vec2 normal = centerToPlane >= 0 ? plane->getNormal() : -plane->getNormal();
+
+	if (abs(centerToPlane) <= radius)
+	{
+		hit.fTime = 0;
+		hit.normal = StartNormal(displacement);
+		hit.point = center - normal * centerToPlane;
+		return true;
+	}
+
+	float fApproach = dot(displacement, normal);
+	if (fApproach >= 0)
+		return false;
+
+	float t = (abs(centerToPlane) - radius) / -fApproach;
+	if (t > 1)
+		return false;
+
+	hit.fTime = t;
+	hit.normal = normal;
+	hit.point = center + displacement * t - normal * radius;
+	return true;
+}
+
+bool SceneQuery::ShapeCast(Sphere* sphere, vec2 const& displacement, Sphere* sphere2, ShapeCastHit& hit)
+{
+	vec2 center = sphere->getPosition();
+	vec2 target = sphere2->getPosition();
+	float radiusSum = sphere->getRadius() + sphere2->getRadius();
+
+	vec2 toCenter = center - target;
+	float c = dot(toCenter, toCenter) - radiusSum * radiusSum;
+	if (c <= 0)
+	{
+		hit.fTime = 0;
+		hit.normal = StartNormal(displacement);
+		hit.point = center;
+		return true;
+	}
+
+	float fLengthSq = dot(displacement, displacement);
+	float b = dot(toCenter, displacement);
+	if (fLengthSq == 0 || b >= 0)
+		return false;
+
+	float discriminant = b * b - fLengthSq * c;
+	if (discriminant < 0)
+		return false;
+
+	float t = (-b - sqrtf(discriminant)) / fLengthSq;
+	if (t > 1)
+		return false;
+
+	hit.fTime = t;
+	hit.normal = normalize(center + displacement * t - target);
+	hit.point = target + hit.normal * sphere2->getRadius();
+	return true;
+}
+
+bool SceneQuery::ShapeCast(Sphere* sphere, vec2 const& displacement, Box* box, ShapeCastHit& hit)
+{
+	return SweepCircle(sphere->getPosition(), sphere->getRadius(), displacement, BoxHull(box), hit);
+}
+
+bool SceneQuery::ShapeCast(Sphere* sphere, vec2 const& displacement, Poly* poly, ShapeCastHit& hit)
+{
+	if (poly->GetVerticeCount() < 3)
+		return false;
+
+	return SweepCircle(sphere->getPosition(), sphere->getRadius(), displacement, PolyHull(poly, NormalSign(poly)), hit);
+}
+
+bool SceneQuery::ShapeCast(Sphere* sphere, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit)
+{
+	return ShapeCastStitched(sphere, displacement, stitched, hit);
+}
+
+bool SceneQuery::ShapeCast(Box* box, vec2 const& displacement, Plane* plane, ShapeCastHit& hit)
+{
+	return SweepHullPlane(BoxHull(box), displacement, plane, hit);
+}
+
+bool SceneQuery::ShapeCast(Box* box, vec2 const& displacement, Sphere* sphere, ShapeCastHit& hit)
+{
+	return SweepHullSphere(BoxHull(box), displacement, sphere, hit);
+}
+
+bool SceneQuery::ShapeCast(Box* box, vec2 const& displacement, Box* box2, ShapeCastHit& hit)
+{
+	return SweepHulls(BoxHull(box), displacement, BoxHull(box2), hit);
+}
+
+bool SceneQuery::ShapeCast(Box* box, vec2 const& displacement, Poly* poly, ShapeCastHit& hit)
+{
+	if (poly->GetVerticeCount() < 3)
+		return false;
+
+	return SweepHulls(BoxHull(box), displacement, PolyHull(poly, NormalSign(poly)), hit);
+}
+
+bool SceneQuery::ShapeCast(Box* box, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit)
+{
+	return ShapeCastStitched(box, displacement, stitched, hit);
+}
+
+bool SceneQuery::ShapeCast(Poly* poly, vec2 const& displacement, Plane* plane, ShapeCastHit& hit)
+{
+	if (poly->GetVerticeCount() < 3)
+		return false;
+
+	return SweepHullPlane(PolyHull(poly, NormalSign(poly)), displacement, plane, hit);
+}
+
+bool SceneQuery::ShapeCast(Poly* poly, vec2 const& displacement, Sphere* sphere, ShapeCastHit& hit)
+{
+	if (poly->GetVerticeCount() < 3)
+		return false;
+
+	return SweepHullSphere(PolyHull(poly, NormalSign(poly)), displacement, sphere, hit);
+}
+
+bool SceneQuery::ShapeCast(Poly* poly, vec2 const& displacement, Box* box, ShapeCastHit& hit)
+{
+	if (poly->GetVerticeCount() < 3)
+		return false;
+
+	return SweepHulls(PolyHull(poly, NormalSign(poly)), displacement, BoxHull(box), hit);
+}
+
+bool SceneQuery::ShapeCast(Poly* poly, vec2 const& displacement, Poly* poly2, ShapeCastHit& hit)
+{
+	if (poly->GetVerticeCount() < 3 || poly2->GetVerticeCount() < 3)
+		return false;
+
+	return SweepHulls(PolyHull(poly, NormalSign(poly)), displacement, PolyHull(poly2, NormalSign(poly2)), hit);
+}
+
+bool SceneQuery::ShapeCast(Poly* poly, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit)
+{
+	return ShapeCastStitched(poly, displacement, stitched, hit);
+}
+
+template <class S>
+bool SceneQuery::ShapeCastStitched(S* shape, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit)
+{
+	// Box the swept bounds' corners in the body's space
+	Bounds const& bounds = shape->GetBounds();
+	vec2 sweptMin = min(bounds.min, bounds.min + displacement);
+	vec2 sweptMax = max(bounds.max, bounds.max + displacement);
+
+	Transform const& transform = stitched->GetTransform();
+	vec2 corners[4] =
+	{
+		transform.InvTransformPoint(sweptMin),
+		transform.InvTransformPoint(sweptMax),
+		transform.InvTransformPoint({ sweptMin.x, sweptMax.y }),
+		transform.InvTransformPoint({ sweptMax.x, sweptMin.y }),
+	};
+
+	vec2 localMin = min(min(corners[0], corners[1]), min(corners[2], corners[3]));
+	vec2 localMax = max(max(corners[0], corners[1]), max(corners[2], corners[3]));
+
+	bool bHit = false;
+	stitched->GetGeometry()->ForEachPolyInBounds(localMin, localMax, [&](int polyIndex)
+	{
+		ShapeCastHit polyHit;
+		if (ShapeCast(shape, displacement, stitched->GetPoly(polyIndex), polyHit) && (!bHit || polyHit.fTime < hit.fTime))
+		{
+			hit = polyHit;
+			bHit = true;
+		}
+	});
+
+	return bHit;
+}
+
+float SceneQuery::NormalSign(Poly* poly)
+{
+	PolyGeometry const& geometry = *poly->GetGeometry();
+	return dot(geometry.sNorms[0].norm, geometry.vertices[0] - geometry.centroid) >= 0 ? 1.0f : -1.0f;
+}
+
+bool SceneQuery::RaycastBounds(vec2 const& boundsMin, vec2 const& boundsMax, vec2 const& origin, vec2 const& direction, float fMaxDistance, float& fDistance, vec2& normal)
+{
+	float tEnter = -FLT_MAX;
+	float tExit = fMaxDistance;
+	vec2 enterNormal = -direction;
+
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		if (direction[axis] == 0)
+		{
+			if (origin[axis] < boundsMin[axis] || origin[axis] > boundsMax[axis])
+				return false;
+			continue;
+		}
+
+		// the face nearest the origin along this axis
+		float fNear = direction[axis] > 0 ? boundsMin[axis] : boundsMax[axis];
+		float fFar = direction[axis] > 0 ? boundsMax[axis] : boundsMin[axis];
+		float tNear = (fNear - origin[axis]) / direction[axis];
+		float tFar = (fFar - origin[axis]) / direction[axis];
+
+		if (tNear > tEnter)
+		{
+			tEnter = tNear;
+			enterNormal = vec2(0);
+			enterNormal[axis] = direction[axis] > 0 ? -1.0f : 1.0f;
+		}
+		tExit = glm::min(tExit, tFar);
+	}
+
+	if (tEnter > tExit || tExit < 0)
+		return false;
+
+	if (tEnter < 0)
+	{
+		tEnter = 0;
+		enterNormal = -direction;
+	}
+
+	fDistance = tEnter;
+	normal = enterNormal;
+	return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <glm/ext.hpp>
+#include "PhysicsObject.h"
+
+using namespace glm;
+
+class Plane;
+class Sphere;
+class Box;
+class Poly;
+class Stitched;
+
+struct RaycastHit
+{
+	PhysicsObject* pActor = nullptr;
+	// along the ray's unit direction
+	float fDistance = 0;
+	vec2 point = { 0,0 };
+	// faces back along the ray
+	vec2 normal = { 0,0 };
+};
+
+struct ShapeCastHit
+{
+	PhysicsObject* pActor = nullptr;
+	// fraction of the displacement travelled before touching, 0 if the shape
+	// already overlaps
+	float fTime = 0;
+	vec2 point = { 0,0 };
+	// faces back toward the moving shape
+	vec2 normal = { 0,0 };
+};
+
+// One ray of a batch
+struct RayQuery
+{
+	vec2 origin = { 0,0 };
+	vec2 direction = { 0,0 };
+	float fMaxDistance = 0;
+	// only actors with a category bit in the mask are hit
+	uint32_t uLayerMask = 0xFFFFFFFF;
+};
+
+/***
+ * @brief Exact query tests against one shape, in world space. The scene
+ *			finds candidates with its broadphase and runs these on them.
+ *
+ * Ray directions are unit length. A ray that starts inside a shape hits it
+ *	at distance 0 with its normal facing back along the ray. Planes are the
+ *	infinite lines the solver treats them as, so no point lies inside one.
+ */
+class SceneQuery
+{
+public:
+	static bool Raycast(Plane* plane, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit);
+	static bool Raycast(Sphere* sphere, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit);
+	static bool Raycast(Box* box, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit);
+	static bool Raycast(Poly* poly, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit);
+	static bool Raycast(Stitched* stitched, vec2 const& origin, vec2 const& direction, float fMaxDistance, RaycastHit& hit);
+
+	static bool OverlapPoint(Plane* plane, vec2 const& point);
+	static bool OverlapPoint(Sphere* sphere, vec2 const& point);
+	static bool OverlapPoint(Box* box, vec2 const& point);
+	static bool OverlapPoint(Poly* poly, vec2 const& point);
+	static bool OverlapPoint(Stitched* stitched, vec2 const& point);
+
+	static bool OverlapAABB(Plane* plane, Bounds const& bounds);
+	static bool OverlapAABB(Sphere* sphere, Bounds const& bounds);
+	static bool OverlapAABB(Box* box, Bounds const& bounds);
+	static bool OverlapAABB(Poly* poly, Bounds const& bounds);
+	static bool OverlapAABB(Stitched* stitched, Bounds const& bounds);
+
+	static bool OverlapCircle(Plane* plane, vec2 const& center, float radius);
+	static bool OverlapCircle(Sphere* sphere, vec2 const& center, float radius);
+	static bool OverlapCircle(Box* box, vec2 const& center, float radius);
+	static bool OverlapCircle(Poly* poly, vec2 const& center, float radius);
+	static bool OverlapCircle(Stitched* stitched, vec2 const& center, float radius);
+
+	/***
+	 * @brief Sweeps a shape from its current pose along a displacement, without
+	 *			rotating it, and finds when it first touches a target. Hulls use
+	 *			swept SAT, spheres cast their centre against the target grown
+	 *			by their radius.
+	 */
+	static bool ShapeCast(Sphere* sphere, vec2 const& displacement, Plane* plane, ShapeCastHit& hit);
+	static bool ShapeCast(Sphere* sphere, vec2 const& displacement, Sphere* sphere2, ShapeCastHit& hit);
+	static bool ShapeCast(Sphere* sphere, vec2 const& displacement, Box* box, ShapeCastHit& hit);
+	static bool ShapeCast(Sphere* sphere, vec2 const& displacement, Poly* poly, ShapeCastHit& hit);
+	static bool ShapeCast(Sphere* sphere, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit);
+
+	static bool ShapeCast(Box* box, vec2 const& displacement, Plane* plane, ShapeCastHit& hit);
+	static bool ShapeCast(Box* box, vec2 const& displacement, Sphere* sphere, ShapeCastHit& hit);
+	static bool ShapeCast(Box* box, vec2 const& displacement, Box* box2, ShapeCastHit& hit);
+	static bool ShapeCast(Box* box, vec2 const& displacement, Poly* poly, ShapeCastHit& hit);
+	static bool ShapeCast(Box* box, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit);
+
+	static bool ShapeCast(Poly* poly, vec2 const& displacement, Plane* plane, ShapeCastHit& hit);
+	static bool ShapeCast(Poly* poly, vec2 const& displacement, Sphere* sphere, ShapeCastHit& hit);
+	static bool ShapeCast(Poly* poly, vec2 const& displacement, Box* box, ShapeCastHit& hit);
+	static bool ShapeCast(Poly* poly, vec2 const& displacement, Poly* poly2, ShapeCastHit& hit);
+	static bool ShapeCast(Poly* poly, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit);
+
+private:
+	inline SceneQuery() {};
+	inline ~SceneQuery() {};
+
+	// 1 if the poly's cooked normals point out of the hull, -1 if they point in
+	static float NormalSign(Poly* poly);
+
+	// Sweeps over a Stitched body's sub-polys near the path
+	template <class S>
+	static bool ShapeCastStitched(S* shape, vec2 const& displacement, Stitched* stitched, ShapeCastHit& hit);
+	// Ray against the box min to max, the normal is the face it enters by
+	static bool RaycastBounds(vec2 const& boundsMin, vec2 const& boundsMax, vec2 const& origin, vec2 const& direction, float fMaxDistance, float& fDistance, vec2& normal);
+};
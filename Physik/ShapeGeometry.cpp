@@ -0,0 +1,234 @@
+#include "ShapeGeometry.h"
+#include <algorithm>
+
+std::mutex GeometryRegistry::s_mutex;
+std::unordered_multimap<size_t, weak_ptr<const PolyGeometry>> GeometryRegistry::s_polys;
+std::unordered_multimap<size_t, GeometryRegistry::StitchedEntry> GeometryRegistry::s_stitched;
+size_t GeometryRegistry::s_polyPurgeSize = 64;
+size_t GeometryRegistry::s_stitchedPurgeSize = 64;
+
+shared_ptr<const PolyGeometry> GeometryRegistry::GetPoly(vector<vec2> const & vertices)
+{
+	size_t hash = Hash(vertices, 0);
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	auto range = s_polys.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		shared_ptr<const PolyGeometry> existing = it->second.lock();
+		if (existing && existing->vertices == vertices)
+			return existing;
+	}
+
+	PurgeExpired(s_polys, s_polyPurgeSize);
+
+	shared_ptr<const PolyGeometry> geometry = CookPoly(vertices);
+	s_polys.emplace(hash, geometry);
+	return geometry;
+}
+
+shared_ptr<const StitchedGeometry> GeometryRegistry::GetStitched(vector<vector<vec2>> const & allVertices)
+{
+	size_t hash = allVertices.size();
+	for (int i = 0; i < (int)allVertices.size(); ++i)
+		hash = Hash(allVertices[i], hash);
+
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+
+		auto range = s_stitched.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			shared_ptr<const StitchedGeometry> existing = it->second.geometry.lock();
+			if (existing && it->second.source == allVertices)
+				return existing;
+		}
+	}
+
+	// Cooking takes the lock again for each sub-poly
+	shared_ptr<const StitchedGeometry> geometry = CookStitched(allVertices);
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	PurgeExpired(s_stitched, s_stitchedPurgeSize);
+
+	StitchedEntry entry;
+	entry.geometry = geometry;
+	entry.source = allVertices;
+	s_stitched.emplace(hash, std::move(entry));
+	return geometry;
+}
+
+shared_ptr<PolyGeometry> GeometryRegistry::CookPoly(vector<vec2> const & vertices)
+{
+	auto geometry = std::make_shared<PolyGeometry>();
+	geometry->vertices = vertices;
+
+	int count = (int)vertices.size();
+	if (count == 0)
+		return geometry;
+
+	geometry->boundsMin = vertices[0];
+	geometry->boundsMax = vertices[0];
+	for (int i = 0; i < count; ++i)
+	{
+		geometry->fRadius = max(geometry->fRadius, length(vertices[i]));
+		geometry->boundsMin = min(geometry->boundsMin, vertices[i]);
+		geometry->boundsMax = max(geometry->boundsMax, vertices[i]);
+		geometry->centroid += vertices[i];
+	}
+
+	geometry->centroid /= (float)count;
+	for (int i = 0; i < count; ++i)
+		geometry->fCentroidRadius = max(geometry->fCentroidRadius, distance(vertices[i], geometry->centroid));
+
+	vector<SurfaceNorm>& sNorms = geometry->sNorms;
+	for (int i = 0; i < count; ++i)
+	{
+		int j = i + 1;
+		if (j >= count)
+			j = 0;
+
+		vec2 vec = vertices[i] - vertices[j];
+
+		vec2 norm;
+		norm.x = vec.y;
+		norm.y = -vec.x;
+
+		norm = normalize(norm);
+
+		SurfaceNorm sNorm;
+		sNorm.norm = norm;
+
+		sNorms.push_back(sNorm);
+	}
+
+	// Parallel check
+	for (int i = 0; i < ((int)sNorms.size() - 1); ++i)
+	{
+		for (int j = i + 1; j < (int)sNorms.size(); ++j)
+		{
+			vec2 lhs = sNorms[i].norm;
+			vec2 rhs = sNorms[j].norm;
+
+			float check = dot(lhs, rhs);
+
+			if (abs(check) >= 1 - FLT_EPSILON)
+			{
+				sNorms[j].hasParallel = true;
+			}
+		}
+	}
+
+	return geometry;
+}
+
+shared_ptr<StitchedGeometry> GeometryRegistry::CookStitched(vector<vector<vec2>> const & allVertices)
+{
+	auto geometry = std::make_shared<StitchedGeometry>();
+
+	for (int i = 0; i < (int)allVertices.size(); ++i)
+	{
+		vec2 pos = vec2(0.0f, 0.0f);
+		for (int j = 0; j < (int)allVertices[i].size(); ++j)
+		{
+			pos += allVertices[i][j];
+		}
+		pos /= (float)allVertices[i].size();
+		geometry->polyOffsets.push_back(Transform(pos, 0));
+
+		vector<vec2> verts;
+		for (int j = 0; j < (int)allVertices[i].size(); ++j)
+		{
+			verts.push_back(allVertices[i][j] - pos);
+		}
+
+		geometry->polys.push_back(GetPoly(verts));
+	}
+
+	vector<int> polyIndices;
+	for (int i = 0; i < (int)geometry->polys.size(); ++i)
+		polyIndices.push_back(i);
+
+	if (!polyIndices.empty())
+	{
+		geometry->bvh.reserve(polyIndices.size() * 2);
+		BuildBVH(*geometry, polyIndices, 0, (int)polyIndices.size());
+	}
+
+	return geometry;
+}
+
+int GeometryRegistry::BuildBVH(StitchedGeometry & geometry, vector<int>& polyIndices, int first, int count)
+{
+	int nodeIndex = (int)geometry.bvh.size();
+	geometry.bvh.push_back(StitchedBVHNode());
+
+	vec2 boundsMin = vec2(FLT_MAX);
+	vec2 boundsMax = vec2(-FLT_MAX);
+	for (int i = first; i < first + count; ++i)
+	{
+		int poly = polyIndices[i];
+		vec2 offset = geometry.polyOffsets[poly].GetPosition();
+		boundsMin = min(boundsMin, geometry.polys[poly]->boundsMin + offset);
+		boundsMax = max(boundsMax, geometry.polys[poly]->boundsMax + offset);
+	}
+
+	if (count == 1)
+	{
+		StitchedBVHNode& node = geometry.bvh[nodeIndex];
+		node.boundsMin = boundsMin;
+		node.boundsMax = boundsMax;
+		node.polyIndex = polyIndices[first];
+		return nodeIndex;
+	}
+
+	// Median split along the longest side
+	int axis = (boundsMax.x - boundsMin.x >= boundsMax.y - boundsMin.y) ? 0 : 1;
+	std::sort(polyIndices.begin() + first, polyIndices.begin() + first + count, [&](int a, int b)
+	{
+		return geometry.polyOffsets[a].GetPosition()[axis] < geometry.polyOffsets[b].GetPosition()[axis];
+	});
+
+	int half = count / 2;
+	int left = BuildBVH(geometry, polyIndices, first, half);
+	int right = BuildBVH(geometry, polyIndices, first + half, count - half);
+
+	StitchedBVHNode& node = geometry.bvh[nodeIndex];
+	node.boundsMin = boundsMin;
+	node.boundsMax = boundsMax;
+	node.left = left;
+	node.right = right;
+	return nodeIndex;
+}
+
+size_t GeometryRegistry::Hash(vector<vec2> const & vertices, size_t seed)
+{
+	// FNV-1a over the raw vertex bits
+	uint64_t hash = 14695981039346656037ull ^ (uint64_t)seed;
+	const unsigned char* bytes = (const unsigned char*)vertices.data();
+	for (size_t i = 0; i < vertices.size() * sizeof(vec2); ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return (size_t)hash;
+}
+
+template <class T>
+void GeometryRegistry::PurgeExpired(std::unordered_multimap<size_t, T>& entries, size_t & purgeSize)
+{
+	if (entries.size() < purgeSize)
+		return;
+
+	for (auto it = entries.begin(); it != entries.end();)
+	{
+		if (IsExpired(it->second))
+			it = entries.erase(it);
+		else
+			++it;
+	}
+
+	purgeSize = std::max<size_t>(64, entries.size() * 2);
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <glm/ext.hpp>
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <mutex>
+#include <unordered_map>
+#include "Transform.h"
+
+using namespace glm;
+using std::vector;
+using std::shared_ptr;
+using std::weak_ptr;
+
+struct SurfaceNorm
+{
+	vec2 norm = {0,0};
+	bool hasParallel = false;
+};
+
+/***
+ * @brief Cooked, immutable hull shared by every Poly built from the same
+ *			vertices
+ */
+struct PolyGeometry
+{
+	vector<vec2> vertices;
+	// edge normals, later normals parallel to an earlier one are flagged
+	vector<SurfaceNorm> sNorms;
+
+	// furthest vertex from the local origin
+	float fRadius = 0;
+	// vertex average and the furthest vertex from it
+	vec2 centroid = { 0,0 };
+	float fCentroidRadius = 0;
+	vec2 boundsMin = { 0,0 };
+	vec2 boundsMax = { 0,0 };
+};
+
+struct StitchedBVHNode
+{
+	vec2 boundsMin;
+	vec2 boundsMax;
+	// children are only valid when polyIndex is -1
+	int left = -1;
+	int right = -1;
+	int polyIndex = -1;
+};
+
+/***
+ * @brief Cooked sub-hulls of a Stitched body, each recentred on its own
+ *			centroid, with a BVH over their bounds in the body's local space
+ */
+struct StitchedGeometry
+{
+	vector<shared_ptr<const PolyGeometry>> polys;
+	vector<Transform> polyOffsets;
+	// built in preorder, so a node's children come after it
+	vector<StitchedBVHNode> bvh;
+
+	// Deepest BVH the traversal stack holds, deeper loaded trees are rejected
+	static const int BVH_STACK_SIZE = 64;
+
+	/***
+	 * @brief Calls func(polyIndex) for every sub-poly whose bounds overlap a
+	 *			box in the body's local space
+	 */
+	template <class F>
+	void ForEachPolyInBounds(vec2 const& boundsMin, vec2 const& boundsMax, F&& func) const
+	{
+		if (bvh.empty())
+			return;
+
+		int stack[BVH_STACK_SIZE];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			StitchedBVHNode const& node = bvh[stack[--stackSize]];
+			if (node.boundsMin.x > boundsMax.x || node.boundsMax.x < boundsMin.x ||
+				node.boundsMin.y > boundsMax.y || node.boundsMax.y < boundsMin.y)
+				continue;
+
+			if (node.polyIndex >= 0)
+			{
+				func(node.polyIndex);
+			}
+			else
+			{
+				// Cooked trees are median split and loaded ones depth checked
+				assert(stackSize + 2 <= BVH_STACK_SIZE && "Stitched BVH deeper than the traversal stack");
+				stack[stackSize++] = node.left;
+				stack[stackSize++] = node.right;
+			}
+		}
+	}
+};
+
+/***
+ * @brief Cooks hull geometry once and hands out shared references to it.
+ *			Geometry is freed when the last body using it is destroyed.
+ */
+class GeometryRegistry
+{
+public:
+	static shared_ptr<const PolyGeometry> GetPoly(vector<vec2> const& vertices);
+	static shared_ptr<const StitchedGeometry> GetStitched(vector<vector<vec2>> const& allVertices);
+
+private:
+	inline GeometryRegistry() {};
+	inline ~GeometryRegistry() {};
+
+	static shared_ptr<PolyGeometry> CookPoly(vector<vec2> const& vertices);
+	static shared_ptr<StitchedGeometry> CookStitched(vector<vector<vec2>> const& allVertices);
+	static int BuildBVH(StitchedGeometry& geometry, vector<int>& polyIndices, int first, int count);
+
+	static size_t Hash(vector<vec2> const& vertices, size_t seed);
+
+	struct StitchedEntry
+	{
+		weak_ptr<const StitchedGeometry> geometry;
+		// kept to tell hash collisions apart
+		vector<vector<vec2>> source;
+	};
+
+	static inline bool IsExpired(weak_ptr<const PolyGeometry> const& entry) { return entry.expired(); };
+	static inline bool IsExpired(StitchedEntry const& entry) { return entry.geometry.expired(); };
+
+	template <class T>
+	static void PurgeExpired(std::unordered_multimap<size_t, T>& entries, size_t& purgeSize);
+
+	static std::mutex s_mutex;
+	static std::unordered_multimap<size_t, weak_ptr<const PolyGeometry>> s_polys;
+	static std::unordered_multimap<size_t, StitchedEntry> s_stitched;
+	static size_t s_polyPurgeSize;
+	static size_t s_stitchedPurgeSize;
+};
@@ -1,74 +1,108 @@
-#include "Stitched.h"
-
-Stitched::Stitched(vector<vector<vec2>> const & allVertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour) :
-	RigidBody(ShapeID::Stitched, position, velocity, rotation, fAngVel, mass, elasticity, fFricCoStatic, fFricCoDynamic, fDrag, fAngDrag)
-{
-	m_Colour = colour;
-
-	Transform pos = Transform();
-	pos.SetPosition(m_position);
-
-	Transform rot = Transform();
-	rot.SetRotate2D(m_rotation);
-
-	m_GlobalTransform.LocalTransform(pos.GetTransform(), rot.GetTransform(), Transform::Identity());
-
-	for (int i = 0; i < allVertices.size(); ++i)
-	{
-		vec2 pos = vec2(0.0f, 0.0f);
-		for (int j = 0; j < allVertices[i].size(); ++j)
-		{
-			pos += allVertices[i][j];
-		}
-		pos /= (float)allVertices[i].size();
-		m_PolyRelPos.push_back(pos);
-
-		vector<vec2> verts;
-		for (int j = 0; j < allVertices[i].size(); ++j)
-		{
-			verts.push_back(allVertices[i][j] - pos);
-		}
-		
-		Poly* poly = new Poly(verts, position + pos, { 0,0 }, rotation, 1, 1, 1, 1, 1, 1, 1, colour);
-		m_Polys.push_back(poly);
-	}
-}
-
-Stitched::~Stitched()
-{
-	for (int i = 0; i < m_Polys.size(); ++i)
-	{
-		delete m_Polys[i];
-	}
-}
-
-void Stitched::fixedUpdate(vec2 const& gravity, float timeStep)
-{
-	RigidBody::fixedUpdate(gravity, timeStep);
-	
-	Transform pos = Transform();
-	pos.SetPosition(m_position);
-
-	Transform rot = Transform();
-	rot.SetRotate2D(m_rotation);
-
-	m_GlobalTransform.LocalTransform(pos.GetTransform(), rot.GetTransform(), Transform::Identity());
-	
-	for (int i = 0; i < m_Polys.size(); ++i)
-	{
-		Transform pos;
-		pos.SetPosition(m_PolyRelPos[i]);
-
-		m_Polys[i]->Move(m_GlobalTransform, pos);
-	}
-}
-
-
-void Stitched::makeGizmo()
-{
-	for (int i = 0; i < m_Polys.size(); ++i)
-	{
-		m_Polys[i]->SetIsFilled(m_bIsFilled);
-		m_Polys[i]->makeGizmo();
-	}
-}
+#include "Stitched.h"
+
+Stitched::Stitched(vector<vector<vec2>> const & allVertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour) :
+	Stitched(GeometryRegistry::GetStitched(allVertices), position, velocity, rotation, fAngVel, mass, elasticity, fFricCoStatic, fFricCoDynamic, fDrag, fAngDrag, colour)
+{
+}
+
+Stitched::Stitched(shared_ptr<const StitchedGeometry> const& pGeometry, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour) :
+	RigidBody(ShapeID::Stitched, position, velocity, rotation, fAngVel, mass, elasticity, fFricCoStatic, fFricCoDynamic, fDrag, fAngDrag)
+{
+	m_Colour = colour;
+	m_pGeometry = pGeometry;
+
+	m_GlobalTransform.Set(m_position, m_rotation);
+
+	for (int i = 0; i < m_pGeometry->polys.size(); ++i)
+	{
+		vec2 pos = m_pGeometry->polyOffsets[i].GetPosition();
+
+		Poly* poly = new Poly(m_pGeometry->polys[i], position + pos, { 0,0 }, rotation, 1, 1, 1, 1, 1, 1, 1, colour);
+		poly->Move(m_GlobalTransform, m_pGeometry->polyOffsets[i]);
+		m_Polys.push_back(poly);
+	}
+
+	UpdateBounds();
+}
+
+Stitched::~Stitched()
+{
+	for (int i = 0; i < m_Polys.size(); ++i)
+	{
+		delete m_Polys[i];
+	}
+}
+
+void Stitched::fixedUpdate(vec2 const& gravity, float timeStep)
+{
+	RigidBody::fixedUpdate(gravity, timeStep);
+	
+	m_GlobalTransform.Set(m_position, m_rotation);
+	
+	for (int i = 0; i < m_Polys.size(); ++i)
+	{
+		m_Polys[i]->Move(m_GlobalTransform, m_pGeometry->polyOffsets[i]);
+	}
+}
+
+
+void Stitched::DrawGizmo(BodyState const& state) const
+{
+	Transform transform(state.position, state.rotation);
+	Transform polyTransform;
+
+	for (int i = 0; i < m_Polys.size(); ++i)
+	{
+		polyTransform.GlobalTransform(transform, m_pGeometry->polyOffsets[i]);
+		m_Polys[i]->DrawAt(polyTransform, state.bIsFilled);
+	}
+}
+
+void Stitched::SetPose(vec2 const& position, float rotation)
+{
+	m_position = position;
+	m_rotation = rotation;
+	m_GlobalTransform.Set(m_position, m_rotation);
+
+	for (int i = 0; i < m_Polys.size(); ++i)
+	{
+		m_Polys[i]->Move(m_GlobalTransform, m_pGeometry->polyOffsets[i]);
+	}
+
+	UpdateBounds();
+}
+
+void Stitched::SaveSnapshot(BodySnapshot& snapshot) const
+{
+	RigidBody::SaveSnapshot(snapshot);
+	snapshot.transform = m_GlobalTransform;
+}
+
+void Stitched::LoadSnapshot(BodySnapshot const& snapshot)
+{
+	RigidBody::LoadSnapshot(snapshot);
+	m_GlobalTransform = snapshot.transform;
+
+	// The sub-polys were last moved and bounded from this transform, doing
+	// it again puts them back exactly
+	for (int i = 0; i < m_Polys.size(); ++i)
+	{
+		m_Polys[i]->Move(m_GlobalTransform, m_pGeometry->polyOffsets[i]);
+		m_Polys[i]->UpdateBounds();
+	}
+}
+
+void Stitched::UpdateBounds()
+{
+	m_Bounds.min = vec2(FLT_MAX);
+	m_Bounds.max = vec2(-FLT_MAX);
+
+	for (int i = 0; i < m_Polys.size(); ++i)
+	{
+		m_Polys[i]->UpdateBounds();
+
+		Bounds const& polyBounds = m_Polys[i]->GetBounds();
+		m_Bounds.min = min(m_Bounds.min, polyBounds.min);
+		m_Bounds.max = max(m_Bounds.max, polyBounds.max);
+	}
+}
\ No newline at end of file
@@ -1,29 +1,48 @@
-#pragma once
-#include "RigidBody.h"
-#include "Poly.h"
-#include <vector>
-#include "Transform.h"
-
-using std::vector;
-
-class Stitched :
-	public RigidBody
-{
-public:
-	Stitched(vector<vector<vec2>> const& allVertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour);
-	~Stitched();
-
-	void fixedUpdate(vec2 const& gravity, float timeStep);
-	void makeGizmo();
-
-	inline int GetPolyCount() const& { return (int)m_Polys.size(); };
-	inline Poly* GetPoly(int index) const { return m_Polys[index]; };
-
-private:
-	Transform m_GlobalTransform;
-
-	vector<vec2> m_PolyRelPos;
-	vector<Poly*> m_Polys;
-	vec4 m_Colour;
-};
-
+#pragma once
+#include "RigidBody.h"
+#include "Poly.h"
+#include <vector>
+#include "Transform.h"
+
+using std::vector;
+
+class Stitched :
+	public RigidBody
+{
+public:
+	Stitched(vector<vector<vec2>> const& allVertices, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour);
+	Stitched(shared_ptr<const StitchedGeometry> const& pGeometry, vec2 position, vec2 velocity, float rotation, float fAngVel, float mass, float elasticity, float fFricCoStatic, float fFricCoDynamic, float fDrag, float fAngDrag, glm::vec4 colour);
+	~Stitched();
+
+	void fixedUpdate(vec2 const& gravity, float timeStep);
+	void DrawGizmo(BodyState const& state) const;
+	void UpdateBounds();
+	void SetPose(vec2 const& position, float rotation);
+	void SaveSnapshot(BodySnapshot& snapshot) const;
+	void LoadSnapshot(BodySnapshot const& snapshot);
+
+	inline int GetPolyCount() const& { return (int)m_Polys.size(); };
+	inline Poly* GetPoly(int index) const { return m_Polys[index]; };
+	inline shared_ptr<const StitchedGeometry> const& GetGeometry() const { return m_pGeometry; };
+	inline Transform const& GetTransform() const { return m_GlobalTransform; };
+	inline vec4 GetColour() const { return m_Colour; };
+
+	/***
+	 * @brief Calls func(polyIndex) for every sub-poly whose bounds may touch a
+	 *			circle, using the cooked BVH
+	 */
+	template <class F>
+	void ForEachPolyNear(vec2 const& center, float radius, F&& func) const
+	{
+		vec2 local = m_GlobalTransform.InvTransformPoint(center);
+		m_pGeometry->ForEachPolyInBounds(local - vec2(radius), local + vec2(radius), func);
+	}
+
+private:
+	Transform m_GlobalTransform;
+
+	shared_ptr<const StitchedGeometry> m_pGeometry;
+	vector<Poly*> m_Polys;
+	vec4 m_Colour;
+};
+
@@ -0,0 +1,116 @@
+#include "TaskGraph.h"
+
+int TaskGraph::AddTask(const char* szName, std::function<void()> const& func)
+{
+	return AddParallelTask(szName, nullptr, [func](int begin, int end) { func(); }, 1);
+}
+
+int TaskGraph::AddParallelTask(const char* szName, CountFunc const& count, RangeFunc const& func, int grain)
+{
+	Task* pTask = new Task();
+	pTask->szName = szName;
+	pTask->func = func;
+	pTask->count = count;
+	pTask->grain = grain > 0 ? grain : 1;
+
+	m_Tasks.push_back(std::unique_ptr<Task>(pTask));
+
+	// m_Tasks may have moved, so point every job back at its task again
+	m_JobData.resize(m_Tasks.size());
+	for (int i = 0; i < (int)m_JobData.size(); ++i)
+		m_JobData[i] = { this, i };
+
+	return (int)m_Tasks.size() - 1;
+}
+
+void TaskGraph::AddDependency(int task, int dependsOn)
+{
+	m_Tasks[dependsOn]->successors.push_back(task);
+	++m_Tasks[task]->dependencyCount;
+}
+
+void TaskGraph::Run(aie::JobSystem& jobs)
+{
+	m_pJobs = &jobs;
+	m_tasksLeft = (int)m_Tasks.size();
+
+#ifdef PHYSIK_ALLOC_GUARD
+	m_pAllocGuard = AllocGuard::GetCurrent();
+#endif
+
+	for (int i = 0; i < (int)m_Tasks.size(); ++i)
+		m_Tasks[i]->waiting = m_Tasks[i]->dependencyCount;
+
+	for (int i = 0; i < (int)m_Tasks.size(); ++i)
+	{
+		if (m_Tasks[i]->dependencyCount == 0)
+			Start(i);
+	}
+
+#ifdef PHYSIK_ALLOC_GUARD
+	// Jobs picked up while waiting may belong to anyone, this graph's chunks
+	// enter its guard themselves
+	AllocGuard::Scope waitScope(nullptr);
+#endif
+
+	while (m_tasksLeft.load() > 0)
+	{
+		if (!jobs.runOne())
+			std::this_thread::yield();
+	}
+}
+
+void TaskGraph::Start(int task)
+{
+	Task& t = *m_Tasks[task];
+
+	int count = t.count ? t.count() : 1;
+	if (count <= 0)
+	{
+		Finish(task);
+		return;
+	}
+
+	int chunks = (count + t.grain - 1) / t.grain;
+	t.chunksLeft = chunks;
+
+	// Queue all but the first chunk, then run that one here
+	for (int chunk = 1; chunk < chunks; ++chunk)
+	{
+		int begin = chunk * t.grain;
+		int end = begin + t.grain < count ? begin + t.grain : count;
+		m_pJobs->push({ &TaskGraph::RunChunk, &m_JobData[task], begin, end, nullptr });
+	}
+
+	RunChunk(&m_JobData[task], 0, t.grain < count ? t.grain : count);
+}
+
+void TaskGraph::Finish(int task)
+{
+	Task& t = *m_Tasks[task];
+	for (int i = 0; i < (int)t.successors.size(); ++i)
+	{
+		int successor = t.successors[i];
+		if (--m_Tasks[successor]->waiting == 0)
+			Start(successor);
+	}
+
+	// Only after the successors have started, so Run cannot return early
+	--m_tasksLeft;
+}
+
+void TaskGraph::RunChunk(void* pData, int begin, int end)
+{
+	std::pair<TaskGraph*, int>* pJob = (std::pair<TaskGraph*, int>*)pData;
+	TaskGraph* pGraph = pJob->first;
+	Task& t = *pGraph->m_Tasks[pJob->second];
+
+#ifdef PHYSIK_ALLOC_GUARD
+	AllocGuard::Scope scope(pGraph->m_pAllocGuard);
+#endif
+
+	t.func(begin, end);
+
+	if (--t.chunksLeft == 0)
+		pGraph->Finish(pJob->second);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <JobSystem.h>
+#include "AllocGuard.h"
+
+using std::vector;
+
+/***
+ * @brief A fixed set of tasks with explicit dependencies, declared once and
+ *			run as often as needed on an aie::JobSystem. A task starts once every task
+ *			it depends on has finished. Parallel tasks are split into chunks
+ *			that the system's workers share.
+ */
+class TaskGraph
+{
+public:
+	typedef std::function<void(int begin, int end)> RangeFunc;
+	typedef std::function<int()> CountFunc;
+
+	/***
+	 * @brief Adds a task that runs func once
+	 * @return the task's index, for AddDependency
+	 */
+	int AddTask(const char* szName, std::function<void()> const& func);
+
+	/***
+	 * @brief Adds a task that runs func over [0, count()) in chunks of at most
+	 *			grain indices. count is read each run, when the task starts.
+	 * @return the task's index, for AddDependency
+	 */
+	int AddParallelTask(const char* szName, CountFunc const& count, RangeFunc const& func, int grain);
+
+	// task will not start until dependsOn has finished
+	void AddDependency(int task, int dependsOn);
+
+	/***
+	 * @brief Runs every task once, returning when all have finished. The
+	 *			calling thread helps run jobs while it waits.
+	 */
+	void Run(aie::JobSystem& jobs);
+
+	inline int GetTaskCount() const { return (int)m_Tasks.size(); };
+	inline const char* GetTaskName(int task) const { return m_Tasks[task]->szName; };
+
+private:
+	struct Task
+	{
+		const char* szName;
+		RangeFunc func;
+		// null for a task that runs once
+		CountFunc count;
+		int grain = 1;
+
+		vector<int> successors;
+		int dependencyCount = 0;
+
+		// reset every run
+		std::atomic<int> waiting;
+		std::atomic<int> chunksLeft;
+	};
+
+	void Start(int task);
+	void Finish(int task);
+	static void RunChunk(void* pData, int begin, int end);
+
+	vector<std::unique_ptr<Task>> m_Tasks;
+	// the task each chunk job points back to, indexed like m_Tasks
+	vector<std::pair<TaskGraph*, int>> m_JobData;
+
+	aie::JobSystem* m_pJobs = nullptr;
+	std::atomic<int> m_tasksLeft;
+
+#ifdef PHYSIK_ALLOC_GUARD
+	// the guard of the thread that called Run, entered by every chunk
+	AllocGuard* m_pAllocGuard = nullptr;
+#endif
+};
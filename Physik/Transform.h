@@ -1,25 +1,40 @@
-#pragma once
-#include <glm\ext.hpp>
-
-
-class Transform
-{
-public:
-	Transform(glm::mat3* transform = nullptr);
-	~Transform();
-
-	inline glm::mat3 GetTransform() const& { return m_Transform; }
-	glm::vec2 GetPosition() const&;
-	
-	void LocalTransform(glm::mat3 const& posMat, glm::mat3 const& rotMat, glm::mat3 const& scaleMat);
-	void GlobalTransform(glm::mat3 const& global, glm::mat3 const& local);
-	void SetRotate2D(float fRadians);
-	void SetPosition(glm::vec2 const& pos);
-	void SetScale(glm::vec2 const& scale);
-
-	static glm::mat3 Identity();
-
-private:
-	glm::mat3 m_Transform;
-};
-
+#pragma once
+#include <glm\ext.hpp>
+
+// Compact 2D rigid transform, a position plus the cos/sin of its rotation.
+// Composes and inverts without building a matrix.
+class Transform
+{
+public:
+	Transform();
+	Transform(glm::vec2 const& pos, float fRadians);
+	// From an already computed rotation, so a stored transform comes back exactly
+	Transform(glm::vec2 const& pos, float fCos, float fSin);
+
+	inline glm::vec2 GetPosition() const& { return m_Position; }
+	inline float GetCos() const { return m_fCos; }
+	inline float GetSin() const { return m_fSin; }
+
+	void Set(glm::vec2 const& pos, float fRadians);
+	void SetRotate2D(float fRadians);
+	void SetPosition(glm::vec2 const& pos);
+
+	// Rotates a direction from local space into this transform's space
+	inline glm::vec2 Rotate(glm::vec2 const& dir) const { return { m_fCos * dir.x - m_fSin * dir.y, m_fSin * dir.x + m_fCos * dir.y }; }
+	// Rotates a direction from this transform's space back into local space
+	inline glm::vec2 InvRotate(glm::vec2 const& dir) const { return { m_fCos * dir.x + m_fSin * dir.y, m_fCos * dir.y - m_fSin * dir.x }; }
+
+	inline glm::vec2 TransformPoint(glm::vec2 const& point) const { return m_Position + Rotate(point); }
+	inline glm::vec2 InvTransformPoint(glm::vec2 const& point) const { return InvRotate(point - m_Position); }
+
+	void GlobalTransform(Transform const& global, Transform const& local);
+	Transform Inverse() const;
+	Transform operator*(Transform const& local) const;
+
+	static Transform Identity();
+
+private:
+	glm::vec2 m_Position;
+	float m_fCos;
+	float m_fSin;
+};
@@ -1,18 +1,24 @@
-#include <crtdbg.h>
-#include "PhysikApp.h"
-
-int main() {
-	// Memory leak checker
-	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
-
-	// allocation
-	auto app = new PhysikApp();
-
-	// initialise and loop
-	app->run("AIE", 1280, 720, false);
-
-	// deallocation
-	delete app;
-
-	return 0;
+#include <crtdbg.h>
+#include "PhysikApp.h"
+#include "AllocGuard.h"
+
+int main() {
+#ifdef PHYSIK_ALLOC_GUARD
+	// The AllocGuard configuration checks the scene headless instead
+	return RunAllocGuardTest();
+#endif
+
+	// Memory leak checker
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+
+	// allocation
+	auto app = new PhysikApp();
+
+	// initialise and loop
+	app->run("AIE", 1280, 720, false);
+
+	// deallocation
+	delete app;
+
+	return 0;
 }
\ No newline at end of file
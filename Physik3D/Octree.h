@@ -1,264 +1,378 @@
-#pragma once
-
-#include <vector>
-#include <glm/ext.hpp>
-
-using namespace glm;
-using std::vector;
-
-// forward declare so we can make a pointer in OctObject
-template <class T>
-class Octree;
-
-struct OctCube
-{
-	vec3 min;
-	vec3 max;
-};
-
-template <class T>
-struct OctObject
-{
-	T data;
-	OctCube volume;
-	Octree<T>* parent;
-};
-
-template <class T>
-class Octree
-{
-public:
-	Octree(int density, OctCube const& bounds)
-		: m_density(density), m_bounds(bounds)
-	{
-		m_divided = false;
-
-		// this tree isn't dividable (divisible?) if it gets small enough
-		// - stops an eventual stack overflow when trees get tiny
-		const float dividableLimit = 0.2f;
-		m_dividable = bounds.max.x - bounds.min.x >= dividableLimit &&
-			bounds.max.y - bounds.min.y >= dividableLimit;
-	}
-
-	Octree(int density, vec3 const& min, vec3 const& max)
-		: Octree(density, { min, max })
-	{
-	}
-
-	~Octree()
-	{
-		if (m_divided)
-			for (int i = 0; i < 8; ++i)
-				delete m_children[i];
-
-		for (int i = 0; i < m_objects.size(); ++i)
-			delete m_objects[i];
-		m_objects.clear();
-	}
-
-	/***
-	 * @brief Puts an object into the tree, passing it into child trees if
-	 *			possible
-	 *
-	 * @param object Object to put into the tree
-	 * @param vol Bounding box of this object
-	 */
-	void insert(T object, OctCube const& vol)
-	{
-		if ((m_divided || m_objects.size() >= m_density)
-			&& m_dividable)
-		{
-			if (!m_divided)
-				split();
-
-			// pass it to all relevant segments
-			// (not just one, so large objects get added to every tree they
-			//		touch)
-			for (int i = 0; i < 8; ++i)
-			{
-				Octree<T>* child = m_children[i];
-				if (child->intersects(vol))
-					child->insert(object, vol);
-			}
-		}
-		else
-		{
-			// not divided, so the object can go in this node
-
-			// make an OctObject for this object
-			auto obj = new OctObject<T>();
-			obj->data = object;
-			obj->volume = vol;
-			obj->parent = this;
-
-			// stick it into the array
-			m_objects.push_back(obj);
-		}
-	}
-
-	/***
-	 * @brief Removes all objects and child trees from this tree
-	 */
-	void clear()
-	{
-		if (m_divided)
-			for (int i = 0; i < 8; ++i)
-				delete m_children[i];
-		for (int i = 0; i < m_objects.size(); ++i)
-			delete m_objects[i];
-		m_objects.clear();
-
-		m_divided = false;
-	}
-
-	/***
-	 * @brief Checks of a bounding box intersects this tree
-	 *
-	 * @param vol Bounding box to check for intersection
-	 */
-	bool intersects(OctCube const& vol)
-	{
-		// if any of these are true, we're NOT colliding
-		if (vol.min.y > m_bounds.max.y || vol.max.y < m_bounds.min.y ||
-			vol.min.x > m_bounds.max.x || vol.max.x < m_bounds.min.x ||
-			vol.min.z > m_bounds.max.z || vol.max.z < m_bounds.min.z)
-			return false;
-
-		return true;
-	}
-
-	/***
-	 * @brief Gets all objects in all trees that intersect with a box
-	 *
-	 * @param range Bounding box to check for intersection
-	 * @return Dynamic Array containing all objects within these trees
-	 */
-	vector<T> getInRange(OctCube const& range)
-	{
-		vector<T> result;
-		getInRange(range, &result);
-		return result;
-	}
-
-	/***
-	 * @brief Gets all objects in all trees that intersect with a set of bounds
-	 *
-	 * @return Dynamic Array containing all objects within these trees
-	 */
-	vector<T> getInRange(vec3 const& min, vec3 const& max)
-	{
-		return getInRange({ min, max });
-	}
-
-	bool isDivided() { return m_divided; }
-	Octree* getChild(int i) { return m_children[i]; }
-	OctCube getBounds() { return m_bounds; }
-
-private:
-	// how many objects can be in this tree before it splits
-	int m_density;
-	// bounding box of this tree
-	OctCube m_bounds;
-
-	vector<OctObject<T>*> m_objects;
-
-	// has this tree split
-	bool m_divided;
-	// is this tree large enough to split
-	bool m_dividable;
-	Octree* m_children[8];
-
-	/***
-	 * @brief Splits this tree into 8 equal-sized child trees
-	 */
-	void split()
-	{
-		// get the size of each box (just half as big as this)
-		float depth = (m_bounds.max.z - m_bounds.min.z) / 2.0f;
-		float width = (m_bounds.max.x - m_bounds.min.x) / 2.0f;
-		float height = (m_bounds.max.y - m_bounds.min.y) / 2.0f;
-
-		// index of child we're creating
-		int childIndex = 0;
-		for (int x = 0; x < 2; ++x)
-		{
-			for (int y = 0; y < 2; ++y)
-			{
-				for (int z = 0; z < 2; ++z)
-				{
-					OctCube bounds;
-
-					bounds.min.x = m_bounds.min.x + width * x;
-					bounds.min.y = m_bounds.min.y + height * y;
-					bounds.min.z = m_bounds.min.z + depth * z;
-							  
-					bounds.max.x = bounds.min.x + width;
-					bounds.max.y = bounds.min.y + height;
-					bounds.max.z = bounds.min.z + depth;
-
-					m_children[childIndex] = new Octree<T>(m_density, bounds);
-
-					childIndex++;
-				}
-			}
-		}
-		m_divided = true;
-
-		// move objects into children
-		for (int i = 0; i < m_objects.getCount(); ++i)
-		{
-			// check each child tree to see if this object intersects
-			for (int j = 0; j < 8; ++j)
-			{
-				Octree<T>* child = m_children[j];
-				// and insert it if it does
-				if (child->intersects(m_objects[i]->volume))
-					child->insert(m_objects[i]->data, m_objects[i]->volume);
-			}
-			// we can delete this since we're creating new objects in insert
-			delete m_objects[i];
-		}
-		// all the objects have (hopefully) been passed onto our children
-		m_objects.clear();
-	}
-
-	/***
-	 * @brief Recursively adds items into a list from child trees that
-	 *			intersect with a box
-	 *
-	 * @param cube Box to check for intersections with
-	 * @param list Pointer to a dynamic array to add objects to
-	 */
-	void getInRange(OctCube const& cube, vector<T>* list)
-	{
-		// if this doesn't intersect with this cube, none of our children would
-		//	either, so we can leave
-		if (!intersects(cube))
-			return;
-
-		if (m_divided)
-		{
-			// call this on all our children
-			for (int i = 0; i < 8; ++i)
-				m_children[i]->getInRange(cube, list);
-		}
-		else
-		{
-			// only add objects which aren't already in the list
-			for (int i = 0; i < m_objects.count(); ++i)
-			{
-				bool wasInList = false;
-				for (int j = 0; j < list->count(); ++j)
-				{
-					if (m_objects[i]->data == (*list)[j])
-					{
-						wasInList = true;
-						break;
-					}
-				}
-				if (!wasInList)
-					list->add(m_objects[i]->data);
-			}
-		}
-	}
-};
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <glm/ext.hpp>
+
+using namespace glm;
+using std::vector;
+
+struct OctCube
+{
+	vec3 min;
+	vec3 max;
+};
+
+template <class T>
+struct OctObject
+{
+	T data;
+	OctCube volume;
+};
+
+struct OctNode
+{
+	// loose bounds, the node's cell grown by half its size on every side
+	OctCube bounds;
+	// the 8 children are contiguous from here, -1 for a leaf
+	int firstChild = -1;
+	// run of objects held by this node itself
+	uint32_t first = 0;
+	uint32_t count = 0;
+	int depth = 0;
+};
+
+/***
+ * @brief Loose octree held in flat arrays. Nodes live in one array with each
+ *			node's 8 children next to each other, and each node's objects are
+ *			a range of one object array sorted by Morton code.
+ *
+ * An object belongs to the cell holding its centre at the deepest level whose
+ *	cells are at least its size, so it sits inside that cell's loose bounds and
+ *	is stored exactly once. Objects are sorted so every subtree is one run, and
+ *	a node only splits when its run holds more than the density. Objects
+ *	centred outside the tree's bounds are held by the root.
+ *
+ * Inserting only records the object, the nodes are rebuilt from scratch on
+ *	the next query or build(). Arrays keep their capacity through clear(), so
+ *	a tree rebuilt every frame stops allocating once it has grown. Queries
+ *	don't write to the tree once it is built, call build() before querying
+ *	from several threads.
+ */
+template <class T>
+class Octree
+{
+public:
+	// deepest a node can be, 3 bits of Morton code per level
+	static const int MAX_DEPTH = 10;
+
+	Octree(int density, OctCube const& bounds)
+		: m_density(density), m_bounds(bounds)
+	{
+	}
+
+	Octree(int density, vec3 const& min, vec3 const& max)
+		: Octree(density, { min, max })
+	{
+	}
+
+	/***
+	 * @brief Puts an object into the tree, it is sorted into a node at the
+	 *			next build
+	 *
+	 * @param object Object to put into the tree
+	 * @param vol Bounding box of this object
+	 */
+	void insert(T object, OctCube const& vol)
+	{
+		m_objects.push_back({ object, vol });
+		m_dirty = true;
+	}
+
+	/***
+	 * @brief Removes all objects and nodes, keeping the memory for the next fill
+	 */
+	void clear()
+	{
+		m_objects.clear();
+		m_sorted.clear();
+		m_nodes.clear();
+		m_dirty = true;
+	}
+
+	// Sizes the arrays for a number of objects ahead of a fill
+	void reserve(int objectCount)
+	{
+		m_objects.reserve(objectCount);
+		m_sorted.reserve(objectCount);
+		m_keys.reserve(objectCount);
+		m_scratch.reserve(objectCount);
+	}
+
+	/***
+	 * @brief Sorts the inserted objects by Morton code and builds the nodes
+	 *			over the sorted runs, breadth first
+	 */
+	void build()
+	{
+		uint32_t objectCount = (uint32_t)m_objects.size();
+
+		// world to cells at MAX_DEPTH
+		vec3 cellScale = float(1 << MAX_DEPTH) / (m_bounds.max - m_bounds.min);
+
+		m_keys.resize(objectCount);
+		for (uint32_t i = 0; i < objectCount; ++i)
+			m_keys[i] = makeKey(m_objects[i].volume, cellScale) | i;
+		sortKeys();
+
+		m_sorted.resize(objectCount);
+		for (uint32_t i = 0; i < objectCount; ++i)
+			m_sorted[i] = m_objects[m_keys[i] & INDEX_MASK];
+
+		const float infinity = std::numeric_limits<float>::infinity();
+		OctNode root;
+		root.bounds = { vec3(-infinity), vec3(infinity) };
+		root.count = objectCount;
+
+		m_nodes.clear();
+		m_nodes.push_back(root);
+
+		// children are appended, so this reaches them after their parent's level
+		for (int i = 0; i < (int)m_nodes.size(); ++i)
+			split(i);
+
+		m_dirty = false;
+	}
+
+	/***
+	 * @brief Checks of a bounding box intersects this tree
+	 *
+	 * @param vol Bounding box to check for intersection
+	 */
+	bool intersects(OctCube const& vol) const
+	{
+		return overlaps(vol, m_bounds);
+	}
+
+	/***
+	 * @brief Gets all objects in all trees that intersect with a box
+	 *
+	 * @param range Bounding box to check for intersection
+	 * @return Dynamic Array containing all objects within these trees
+	 */
+	vector<T> getInRange(OctCube const& range)
+	{
+		vector<T> result;
+		getInRange(range, result);
+		return result;
+	}
+
+	/***
+	 * @brief Gets all objects in all trees that intersect with a set of bounds
+	 *
+	 * @return Dynamic Array containing all objects within these trees
+	 */
+	vector<T> getInRange(vec3 const& min, vec3 const& max)
+	{
+		return getInRange({ min, max });
+	}
+
+	/***
+	 * @brief Appends every object whose box intersects a range. Each object is
+	 *			held by one node, so none is listed twice.
+	 *
+	 * @param range Bounding box to check for intersection
+	 * @param list Dynamic array to add objects to, not cleared first
+	 */
+	void getInRange(OctCube const& range, vector<T>& list)
+	{
+		if (m_dirty)
+			build();
+
+		// each level pops one node and pushes at most 8
+		int stack[7 * MAX_DEPTH + 1];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			OctNode const& node = m_nodes[stack[--stackSize]];
+			if (!overlaps(node.bounds, range))
+				continue;
+
+			for (uint32_t i = node.first; i < node.first + node.count; ++i)
+			{
+				if (overlaps(m_sorted[i].volume, range))
+					list.push_back(m_sorted[i].data);
+			}
+
+			if (node.firstChild >= 0)
+			{
+				for (int i = 0; i < 8; ++i)
+					stack[stackSize++] = node.firstChild + i;
+			}
+		}
+	}
+
+	inline bool isDivided() const { return !m_nodes.empty() && m_nodes[0].firstChild >= 0; };
+	// node 0 is the root, valid once built
+	inline int getNodeCount() const { return (int)m_nodes.size(); };
+	inline OctNode const& getNode(int i) const { return m_nodes[i]; };
+	// objects in node order, a node's run is first to first + count
+	inline OctObject<T> const& getObject(int i) const { return m_sorted[i]; };
+	inline int getObjectCount() const { return (int)m_objects.size(); };
+	inline OctCube getBounds() const { return m_bounds; };
+
+private:
+	/***
+	 * Key layout, high to low. The object's cell at MAX_DEPTH as a Morton code,
+	 *	zeroed below its own level, then its level, then its index in
+	 *	m_objects. Sorting puts a node's own objects ahead of its children's.
+	 */
+	static const int INDEX_BITS = 30;
+	static const int LEVEL_BITS = 4;
+	static const int CODE_BITS = 3 * MAX_DEPTH;
+	static const uint64_t INDEX_MASK = (1ull << INDEX_BITS) - 1;
+	static const uint64_t LEVEL_MASK = (1ull << LEVEL_BITS) - 1;
+
+	// how many objects can be in a node before it splits
+	int m_density;
+	// bounding box the cells divide, the root's cell
+	OctCube m_bounds;
+
+	// as inserted
+	vector<OctObject<T>> m_objects;
+	// reordered by key, what the nodes' runs index
+	vector<OctObject<T>> m_sorted;
+	vector<OctNode> m_nodes;
+	vector<uint64_t> m_keys;
+	// radix sort's second buffer
+	vector<uint64_t> m_scratch;
+
+	// objects were inserted or cleared since the last build
+	bool m_dirty = true;
+
+	static inline bool overlaps(OctCube const& a, OctCube const& b)
+	{
+		// if any of these are true, we're NOT colliding
+		return !(a.min.y > b.max.y || a.max.y < b.min.y ||
+			a.min.x > b.max.x || a.max.x < b.min.x ||
+			a.min.z > b.max.z || a.max.z < b.min.z);
+	}
+
+	static inline int getLevel(uint64_t key) { return (int)((key >> INDEX_BITS) & LEVEL_MASK); };
+	// the 3 bits picking a child at a level below the root
+	static inline int getOctant(uint64_t key, int level) { return (int)((key >> (INDEX_BITS + LEVEL_BITS + 3 * (MAX_DEPTH - level))) & 7); };
+
+	// Spreads the low 10 bits of a cell coordinate 3 apart
+	static inline uint64_t spreadBits(uint32_t v)
+	{
+		uint64_t x = v & 0x3FF;
+		x = (x | (x << 16)) & 0x30000FF;
+		x = (x | (x << 8)) & 0x300F00F;
+		x = (x | (x << 4)) & 0x30C30C3;
+		x = (x | (x << 2)) & 0x9249249;
+		return x;
+	}
+
+	// Smallest power of 2 at least a positive float, as its exponent
+	static inline int ceilLog2(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		int exponent = (int)(bits >> 23) - 127;
+		return (bits & 0x7FFFFF) ? exponent + 1 : exponent;
+	}
+
+	uint64_t makeKey(OctCube const& vol, vec3 const& cellScale) const
+	{
+		// in cells at MAX_DEPTH
+		vec3 centre = ((vol.min + vol.max) * 0.5f - m_bounds.min) * cellScale;
+		vec3 size = (vol.max - vol.min) * cellScale;
+
+		// Outside the root's cell no loose bounds hold it, only the root
+		const float cellCount = float(1 << MAX_DEPTH);
+		if (!(centre.x >= 0 && centre.y >= 0 && centre.z >= 0 &&
+			centre.x < cellCount && centre.y < cellCount && centre.z < cellCount))
+			return 0;
+
+		// deepest level whose cells are at least the object's size on every axis
+		float largest = max(max(size.x, size.y), size.z);
+		int level = largest > 1 ? max(MAX_DEPTH - ceilLog2(largest), 0) : MAX_DEPTH;
+
+		// cell at MAX_DEPTH, then cleared below the object's level
+		uvec3 cell = uvec3(centre);
+		cell = (cell >> uint32_t(MAX_DEPTH - level)) << uint32_t(MAX_DEPTH - level);
+
+		uint64_t code = spreadBits(cell.x) << 2 | spreadBits(cell.y) << 1 | spreadBits(cell.z);
+		return (code << LEVEL_BITS | (uint64_t)level) << INDEX_BITS;
+	}
+
+	// LSD radix sort of the keys on the bits above the index, 12 at a time
+	void sortKeys()
+	{
+		const int DIGIT_BITS = 12;
+		const uint32_t DIGIT_MASK = (1 << DIGIT_BITS) - 1;
+
+		m_scratch.resize(m_keys.size());
+
+		for (int shift = INDEX_BITS; shift < INDEX_BITS + LEVEL_BITS + CODE_BITS; shift += DIGIT_BITS)
+		{
+			uint32_t offsets[1 << DIGIT_BITS] = {};
+			for (uint64_t key : m_keys)
+				++offsets[(key >> shift) & DIGIT_MASK];
+
+			uint32_t offset = 0;
+			for (uint32_t& count : offsets)
+			{
+				uint32_t digitCount = count;
+				count = offset;
+				offset += digitCount;
+			}
+
+			for (uint64_t key : m_keys)
+				m_scratch[offsets[(key >> shift) & DIGIT_MASK]++] = key;
+			m_keys.swap(m_scratch);
+		}
+	}
+
+	/***
+	 * @brief Gives a node 8 children if its run holds more than the density.
+	 *			The node keeps the objects at its own level, the rest of its
+	 *			run is already grouped by child.
+	 */
+	void split(int nodeIndex)
+	{
+		// copied, pushing the children may move the array
+		OctNode node = m_nodes[nodeIndex];
+		if ((int)node.count <= m_density || node.depth >= MAX_DEPTH)
+			return;
+
+		uint32_t end = node.first + node.count;
+		uint32_t own = node.first;
+		while (own < end && getLevel(m_keys[own]) == node.depth)
+			++own;
+		if (own == end)
+			return;
+
+		uint32_t counts[8] = {};
+		for (uint32_t i = own; i < end; ++i)
+			++counts[getOctant(m_keys[i], node.depth + 1)];
+
+		m_nodes[nodeIndex].count = own - node.first;
+		m_nodes[nodeIndex].firstChild = (int)m_nodes.size();
+
+		// The root's cell is m_bounds, any other's is its loose bounds shrunk
+		// by half a cell, which is one child's size
+		vec3 childSize = (m_bounds.max - m_bounds.min) / float(2 << node.depth);
+		vec3 cellMin = node.depth == 0 ? m_bounds.min : node.bounds.min + childSize;
+
+		uint32_t first = own;
+		for (int i = 0; i < 8; ++i)
+		{
+			vec3 childMin = cellMin + vec3((i >> 2) & 1, (i >> 1) & 1, i & 1) * childSize;
+
+			OctNode child;
+			child.bounds.min = childMin - childSize * 0.5f;
+			child.bounds.max = childMin + childSize * 1.5f;
+			child.first = first;
+			child.count = counts[i];
+			child.depth = node.depth + 1;
+			m_nodes.push_back(child);
+
+			first += counts[i];
+		}
+	}
+};
@@ -1,60 +1,60 @@
-#include "Physik3DApp.h"
-#include "Gizmos.h"
-#include "Input.h"
-#include <glm/glm.hpp>
-#include <glm/ext.hpp>
-
-using glm::vec3;
-using glm::vec4;
-using glm::mat4;
-using aie::Gizmos;
-
-Physik3DApp::Physik3DApp() {
-
-}
-
-Physik3DApp::~Physik3DApp() {
-
-}
-
-bool Physik3DApp::startup() {
-	
-	setBackgroundColour(0.25f, 0.25f, 0.25f);
-
-	// initialise gizmo primitive counts
-	Gizmos::create(10000, 10000, 10000, 10000);
-
-	// create simple camera transforms
-	m_viewMatrix = glm::lookAt(vec3(10), vec3(0), vec3(0, 1, 0));
-	m_projectionMatrix = glm::perspective(glm::pi<float>() * 0.25f, 16.0f / 9.0f, 0.1f, 1000.0f);
-
-	return true;
-}
-
-void Physik3DApp::shutdown() {
-
-	Gizmos::destroy();
-}
-
-void Physik3DApp::update(float deltaTime) {
-
-	// wipe the gizmos clean for this frame
-	Gizmos::clear();
-
-	// quit if we press escape
-	aie::Input* input = aie::Input::getInstance();
-
-	if (input->isKeyDown(aie::INPUT_KEY_ESCAPE))
-		quit();
-}
-
-void Physik3DApp::draw() {
-
-	// wipe the screen to the background colour
-	clearScreen();
-
-	// update perspective based on screen size
-	m_projectionMatrix = glm::perspective(glm::pi<float>() * 0.25f, getWindowWidth() / (float)getWindowHeight(), 0.1f, 1000.0f);
-
-	Gizmos::draw(m_projectionMatrix * m_viewMatrix);
+#include "Physik3DApp.h"
+#include "Gizmos.h"
+#include "Input.h"
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+using aie::Gizmos;
+
+Physik3DApp::Physik3DApp() {
+
+}
+
+Physik3DApp::~Physik3DApp() {
+
+}
+
+bool Physik3DApp::startup() {
+	
+	setBackgroundColour(0.25f, 0.25f, 0.25f);
+
+	// initialise gizmo primitive counts
+	Gizmos::create(10000, 10000, 10000, 10000);
+
+	// create simple camera transforms
+	m_viewMatrix = glm::lookAt(vec3(10), vec3(0), vec3(0, 1, 0));
+	m_projectionMatrix = glm::perspective(glm::pi<float>() * 0.25f, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	return true;
+}
+
+void Physik3DApp::shutdown() {
+
+	Gizmos::destroy();
+}
+
+void Physik3DApp::update(float deltaTime) {
+
+	// wipe the gizmos clean for this frame
+	Gizmos::clear();
+
+	// quit if we press escape
+	aie::Input* input = aie::Input::getInstance();
+
+	if (input->isKeyDown(aie::INPUT_KEY_ESCAPE))
+		quit();
+}
+
+void Physik3DApp::draw() {
+
+	// wipe the screen to the background colour
+	clearScreen();
+
+	// update perspective based on screen size
+	m_projectionMatrix = glm::perspective(glm::pi<float>() * 0.25f, getWindowWidth() / (float)getWindowHeight(), 0.1f, 1000.0f);
+
+	Gizmos::draw(m_projectionMatrix * m_viewMatrix);
 }
\ No newline at end of file
@@ -1,15 +1,15 @@
-#include "Physik3DApp.h"
-
-int main() {
-	
-	// allocation
-	auto app = new Physik3DApp();
-
-	// initialise and loop
-	app->run("AIE", 1280, 720, false);
-
-	// deallocation
-	delete app;
-
-	return 0;
+#include "Physik3DApp.h"
+
+int main() {
+	
+	// allocation
+	auto app = new Physik3DApp();
+
+	// initialise and loop
+	app->run("AIE", 1280, 720, false);
+
+	// deallocation
+	delete app;
+
+	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "JobSystem.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace aie {
+
+// the system and deque the calling thread works from, if it is a worker
+static thread_local JobSystem* t_system = nullptr;
+static thread_local int t_worker = -1;
+
+void JobDeque::Slot::store(const Job& job) {
+
+	function.store(job.function, std::memory_order_relaxed);
+	data.store(job.data, std::memory_order_relaxed);
+	begin.store(job.begin, std::memory_order_relaxed);
+	end.store(job.end, std::memory_order_relaxed);
+	counter.store(job.counter, std::memory_order_relaxed);
+}
+
+Job JobDeque::Slot::load() const {
+
+	return { function.load(std::memory_order_relaxed), data.load(std::memory_order_relaxed),
+		begin.load(std::memory_order_relaxed), end.load(std::memory_order_relaxed), counter.load(std::memory_order_relaxed) };
+}
+
+bool JobDeque::push(const Job& job) {
+
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+	if (bottom - top >= CAPACITY)
+		return false;
+
+	m_jobs[bottom & (CAPACITY - 1)].store(job);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+bool JobDeque::pop(Job& job) {
+
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	if (top > bottom) {
+		// already empty
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	job = m_jobs[bottom & (CAPACITY - 1)].load();
+	if (top == bottom) {
+		// last job, race any thief for it
+		bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	return true;
+}
+
+bool JobDeque::steal(Job& job) {
+
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+		return false;
+
+	job = m_jobs[top & (CAPACITY - 1)].load();
+	return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+JobSystem::JobSystem(int workerCount)
+	: m_sharedHead(0),
+	m_sharedCount(0),
+	m_queued(0),
+	m_stop(false) {
+
+	if (workerCount < 0) {
+		workerCount = (int)std::thread::hardware_concurrency() - 1;
+		if (workerCount < 0)
+			workerCount = 0;
+	}
+
+	m_shared.resize(SHARED_CAPACITY);
+
+	m_deques.resize(workerCount);
+	for (auto& deque : m_deques)
+		deque = new JobDeque();
+
+	m_workers.reserve(workerCount);
+	for (int i = 0; i < workerCount; ++i)
+		m_workers.push_back(std::thread(&JobSystem::workerMain, this, i));
+}
+
+JobSystem::~JobSystem() {
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stop = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (auto& worker : m_workers)
+		worker.join();
+
+	for (auto deque : m_deques)
+		delete deque;
+}
+
+JobSystem& JobSystem::getDefault() {
+	static JobSystem s_default;
+	return s_default;
+}
+
+bool JobSystem::setWorkerAffinity(int worker, uint64_t coreMask) {
+
+	if (worker < 0 || worker >= (int)m_workers.size())
+		return false;
+
+#ifdef _WIN32
+	return SetThreadAffinityMask(m_workers[worker].native_handle(), (DWORD_PTR)coreMask) != 0;
+#elif defined(__linux__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (int core = 0; core < 64; ++core)
+		if (coreMask & (1ull << core))
+			CPU_SET(core, &cpus);
+	return pthread_setaffinity_np(m_workers[worker].native_handle(), sizeof(cpus), &cpus) == 0;
+#else
+	return false;
+#endif
+}
+
+void JobSystem::push(const Job& job) {
+
+	if (job.counter != nullptr)
+		job.counter->m_count.fetch_add(1, std::memory_order_relaxed);
+
+	bool queued = (t_system == this) ? m_deques[t_worker]->push(job) : pushShared(job);
+
+	// nowhere to put it, so do it now
+	if (queued == false) {
+		runJob(job);
+		return;
+	}
+
+	m_queued.fetch_add(1, std::memory_order_release);
+
+	// taking the lock means a worker between checking m_queued and sleeping can't miss this
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+	}
+	m_wakeCondition.notify_one();
+}
+
+bool JobSystem::runOne() {
+
+	Job job;
+	bool found = false;
+
+	if (t_system == this)
+		found = m_deques[t_worker]->pop(job);
+
+	if (found == false)
+		found = popShared(job);
+
+	// steal from the other workers, starting after our own deque
+	int count = (int)m_deques.size();
+	int start = (t_system == this) ? t_worker + 1 : 0;
+	for (int i = 0; i < count && found == false; ++i) {
+		int victim = (start + i) % count;
+		if (t_system == this && victim == t_worker)
+			continue;
+		found = m_deques[victim]->steal(job);
+	}
+
+	if (found == false)
+		return false;
+
+	m_queued.fetch_sub(1, std::memory_order_relaxed);
+	runJob(job);
+	return true;
+}
+
+void JobSystem::wait(const JobCounter& counter) {
+
+	while (counter.isDone() == false) {
+		if (runOne() == false)
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::workerMain(int index) {
+
+	t_system = this;
+	t_worker = index;
+
+	while (true) {
+		if (runOne())
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wakeCondition.wait(lock, [this]() { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+		if (m_stop)
+			return;
+	}
+}
+
+void JobSystem::runJob(const Job& job) {
+
+	job.function(job.data, job.begin, job.end);
+
+	if (job.counter != nullptr)
+		job.counter->m_count.fetch_sub(1, std::memory_order_release);
+}
+
+bool JobSystem::pushShared(const Job& job) {
+
+	std::lock_guard<std::mutex> lock(m_sharedMutex);
+	if (m_sharedCount == SHARED_CAPACITY)
+		return false;
+
+	m_shared[(m_sharedHead + m_sharedCount) % SHARED_CAPACITY] = job;
+	++m_sharedCount;
+	return true;
+}
+
+bool JobSystem::popShared(Job& job) {
+
+	std::lock_guard<std::mutex> lock(m_sharedMutex);
+	if (m_sharedCount == 0)
+		return false;
+
+	job = m_shared[m_sharedHead];
+	m_sharedHead = (m_sharedHead + 1) % SHARED_CAPACITY;
+	--m_sharedCount;
+	return true;
+}
+
+} // namespace aie
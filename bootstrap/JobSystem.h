@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aie {
+
+// tracks a group of jobs, each job decrements it when it finishes
+class JobCounter {
+public:
+
+	JobCounter() : m_count(0) {}
+
+	bool isDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+	int getCount() const { return m_count.load(std::memory_order_acquire); }
+
+protected:
+
+	friend class JobSystem;
+
+	std::atomic<int> m_count;
+};
+
+// a unit of work, function is called with data and the [begin, end) range it covers
+struct Job {
+	void		(*function)(void* data, int begin, int end);
+	void*		data;
+	int			begin;
+	int			end;
+	JobCounter*	counter;
+};
+
+// lock-free deque of jobs (Chase-Lev). only the owning worker pushes and pops
+// at the bottom, any thread may steal from the top
+class JobDeque {
+public:
+
+	static const int CAPACITY = 4096;
+
+	JobDeque() : m_top(0), m_bottom(0) {}
+
+	// owner only, returns false if the deque is full
+	bool push(const Job& job);
+	// owner only, takes the newest job
+	bool pop(Job& job);
+	// any thread, takes the oldest job
+	bool steal(Job& job);
+
+	bool isEmpty() const { return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire); }
+
+protected:
+
+	// a thief may copy a slot while the owner refills it after a wrap. its CAS
+	// then fails and the copy is dropped, but the fields are relaxed atomics so
+	// the race is not undefined
+	struct Slot {
+		std::atomic<void (*)(void*, int, int)>	function;
+		std::atomic<void*>						data;
+		std::atomic<int>						begin;
+		std::atomic<int>						end;
+		std::atomic<JobCounter*>				counter;
+
+		void store(const Job& job);
+		Job load() const;
+	};
+
+	std::atomic<int64_t>	m_top;
+	std::atomic<int64_t>	m_bottom;
+	Slot					m_jobs[CAPACITY];
+};
+
+// a pool of worker threads that each own a JobDeque and steal from each other when idle.
+// threads outside the pool submit through a shared queue and can help while they wait
+class JobSystem {
+public:
+
+	// workerCount of -1 creates one worker per hardware thread, less the calling thread
+	JobSystem(int workerCount = -1);
+	~JobSystem();
+
+	// shared instance, created on first use
+	static JobSystem& getDefault();
+
+	int getWorkerCount() const { return (int)m_workers.size(); }
+
+	// pins a worker to the cores in a bit mask, returns false if the platform refused
+	bool setWorkerAffinity(int worker, uint64_t coreMask);
+
+	// queues a job, incrementing its counter if it has one
+	void push(const Job& job);
+
+	// runs one queued job on the calling thread, returns false if none was found
+	bool runOne();
+
+	// fence: helps run jobs until every job tracked by the counter has finished
+	void wait(const JobCounter& counter);
+
+	// calls func(begin, end) over [first, last) in chunks of at most grain, and waits for them all
+	template <typename F>
+	void parallelFor(int first, int last, int grain, const F& func);
+
+protected:
+
+	template <typename F>
+	static void runRange(void* data, int begin, int end) { (*(const F*)data)(begin, end); }
+
+	void workerMain(int index);
+	void runJob(const Job& job);
+	bool pushShared(const Job& job);
+	bool popShared(Job& job);
+
+	std::vector<JobDeque*>		m_deques;
+	std::vector<std::thread>	m_workers;
+
+	// submissions from threads outside the pool
+	static const int SHARED_CAPACITY = 4096;
+	std::mutex					m_sharedMutex;
+	std::vector<Job>			m_shared;
+	int							m_sharedHead;
+	int							m_sharedCount;
+
+	std::atomic<int>			m_queued;
+	std::mutex					m_sleepMutex;
+	std::condition_variable		m_wakeCondition;
+	bool						m_stop;
+};
+
+template <typename F>
+void JobSystem::parallelFor(int first, int last, int grain, const F& func) {
+
+	if (last <= first)
+		return;
+	if (grain < 1)
+		grain = 1;
+
+	JobCounter counter;
+
+	// queue all but the first chunk, then run that one here
+	for (int begin = first + grain; begin < last; begin += grain) {
+		int end = begin + grain < last ? begin + grain : last;
+		push({ &runRange<F>, (void*)&func, begin, end, &counter });
+	}
+
+	func(first, first + grain < last ? first + grain : last);
+
+	wait(counter);
+}
+
+} // namespace aie